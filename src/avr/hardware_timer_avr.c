@@ -87,13 +87,13 @@ const prescalar_t scalarMask[] PROGMEM = {
 };
 
 #ifndef SKIP_TIMER_INDEX
-	#define SKIP_TIMER_INDEX HARD_TIMER_COUNT
+	#define SKIP_TIMER_INDEX HARD_TIMER_HARDWARE_COUNT
 #endif
 
 #ifdef OVERRIDE_ARDUINO_TIMER
-	#define TIMER_COUNT HARD_TIMER_COUNT
+	#define TIMER_COUNT HARD_TIMER_HARDWARE_COUNT
 #else
-	#define TIMER_COUNT HARD_TIMER_COUNT + 1
+	#define TIMER_COUNT HARD_TIMER_HARDWARE_COUNT + 1
 #endif
 
 #if TIMER_COUNT > 0
@@ -130,6 +130,62 @@ const prescalar_t scalarMask[] PROGMEM = {
 
 #define SCALAR_MASK_SIZE (sizeof(scalarMask) / sizeof(prescalar_t)) // size of scalarMask
 
+/**
+ * Tests if timer has its compare A vector defined outside of library,
+ * so it is only set when asked for directly
+ * 
+ * @param timer timer to test
+ */
+#define LEAN_TIMER(timer) \
+	((timer) != HARD_TIMER_INVALID && (timer) < HARD_TIMER_HARDWARE_COUNT && ((HARD_TIMER_AVR_LEAN >> (timer)) & 1))
+
+/**
+ * Tests if compare A vector of hardware timer is defined outside of library,
+ * the skipped hardware timer is never lean as it isn't a library timer
+ * 
+ * @param hw hardware timer number
+ */
+#define LEAN_VECTOR(hw) \
+	((hw) != SKIP_TIMER_INDEX && ((HARD_TIMER_AVR_LEAN >> ((hw) - (SKIP_TIMER_INDEX < (hw)))) & 1))
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+uint16_t compareBDivider[HARD_TIMER_HARDWARE_COUNT]; // compare B matches per compare B expiry
+uint16_t compareBCount[HARD_TIMER_HARDWARE_COUNT]; // compare B matches left until compare B expiry
+timertick_t compareBPhase[HARD_TIMER_HARDWARE_COUNT]; // compare B target within compare A period
+
+/**
+ * Tests if timer is compare B of a hardware timer
+ * 
+ * @param timer timer to test
+ */
+#define IS_COMPARE_B(timer) ((timer) != HARD_TIMER_INVALID && (timer) >= HARD_TIMER_HARDWARE_COUNT)
+
+/**
+ * Gets ticks since last compare B match of hardware timer
+ * 
+ * @param num hardware timer number
+ */
+#define COMPARE_B_LATE(num) \
+	(HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) >= HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B) ? \
+	(hard_timer_tick_t)(HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) - HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B)) : \
+	(hard_timer_tick_t)HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) + HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET) + 1 - \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B))
+
+/**
+ * Runs compare B timer on every divider-th compare B match
+ * 
+ * @param num hardware timer number
+ * @param timer hard_timer_enum_t of compare A
+ */
+#define COMPARE_B_DISPATCH(num, timer) \
+	if (--compareBCount[timer] == 0) { \
+		compareBCount[timer] = compareBDivider[timer]; \
+		HARD_TIMER_DISPATCH((HARD_TIMER_HARDWARE_COUNT + (timer)), COMPARE_B_LATE(num), HARD_TIMER_CONCATENATE3(TIMER_, num, _OVERDUE_B)) \
+	}
+
+#endif
+
 /****************************
  * Timer 0
 ****************************/
@@ -143,10 +199,28 @@ const prescalar_t scalarMask[] PROGMEM = {
 #define TIMER_0_INCR TCCR0A // sets increment mode
 #define TIMER_0_SCAL TCCR0B // sets scalar mode
 #define TIMER_0_INTERR TIMSK0 // sets interrupt
+#define TIMER_0_FLAGS TIFR0 // interrupt flags
 
 #define TIMER_0_SCALAR_ENABLE ((1 << CS00) | (1 << CS01) | (1 << CS02)) // flags for timer 0 scalar
 #define TIMER_0_INTERR_ENABLE (1 << OCIE0A) // flags for timer 0 interrupt
+#define TIMER_0_MATCH_FLAG (1 << OCF0A) // flag for timer 0 compare match
+#define TIMER_0_TOGGLE_ENABLE (1 << COM0A0) // flags for timer 0 pin toggle on compare match
 #define TIMER_0_INCREM_ENABLE (1 << WGM01) // flags for timer 0 increment
+#define TIMER_0_TARGET_B OCR0B // compare B target tick value
+#define TIMER_0_INTERR_B_ENABLE (1 << OCIE0B) // flags for timer 0 compare B interrupt
+#define TIMER_0_MATCH_B_FLAG (1 << OCF0B) // flag for timer 0 compare B match
+
+/**
+ * Tests if timer 0 matched again while callback ran
+ */
+#define TIMER_0_OVERDUE(num, late) (TIMER_0_FLAGS & TIMER_0_MATCH_FLAG)
+
+/**
+ * Tests if compare B of timer 0 matched again while callback ran,
+ * which only overruns when every match expires
+ */
+#define TIMER_0_OVERDUE_B(num, late) \
+	(compareBDivider[(num) - HARD_TIMER_HARDWARE_COUNT] == 1 && (TIMER_0_FLAGS & TIMER_0_MATCH_B_FLAG))
 
 /**
  * sets scalar for timer 0
@@ -164,11 +238,19 @@ const prescalar_t scalarMask[] PROGMEM = {
 		TIMER_0_SCAL |= (1 << CS02); \
 	}
 
+#if !LEAN_VECTOR(0)
 ISR(TIMER0_COMPA_vect) {
 	#if SKIP_TIMER_INDEX != 0
-		((void(*)())hardTimerFunctions[0])(hardTimerParams[0]);
+		HARD_TIMER_DISPATCH(0, TIMER_0_COUNTER, TIMER_0_OVERDUE)
 	#endif
 }
+#endif
+
+#if defined(HARD_TIMER_AVR_COMPARE_B) && SKIP_TIMER_INDEX != 0
+ISR(TIMER0_COMPB_vect) {
+	COMPARE_B_DISPATCH(0, TIMER_0_ALIAS)
+}
+#endif
 
 #endif
 
@@ -185,10 +267,28 @@ ISR(TIMER0_COMPA_vect) {
 #define TIMER_1_INCR TCCR1B // sets increment mode
 #define TIMER_1_SCAL TCCR1B // sets scalar mode
 #define TIMER_1_INTERR TIMSK1 // sets interrupt
+#define TIMER_1_FLAGS TIFR1 // interrupt flags
 
 #define TIMER_1_SCALAR_ENABLE ((1 << CS10) | (1 << CS11) | (1 << CS12)) // flags for timer 1 scalar
 #define TIMER_1_INTERR_ENABLE (1 << OCIE1A) // flags for timer 1 interrupt
+#define TIMER_1_MATCH_FLAG (1 << OCF1A) // flag for timer 1 compare match
+#define TIMER_1_TOGGLE_ENABLE (1 << COM1A0) // flags for timer 1 pin toggle on compare match
 #define TIMER_1_INCREM_ENABLE (1 << WGM12) // flags for timer 1 increment
+#define TIMER_1_TARGET_B OCR1B // compare B target tick value
+#define TIMER_1_INTERR_B_ENABLE (1 << OCIE1B) // flags for timer 1 compare B interrupt
+#define TIMER_1_MATCH_B_FLAG (1 << OCF1B) // flag for timer 1 compare B match
+
+/**
+ * Tests if timer 1 matched again while callback ran
+ */
+#define TIMER_1_OVERDUE(num, late) (TIMER_1_FLAGS & TIMER_1_MATCH_FLAG)
+
+/**
+ * Tests if compare B of timer 1 matched again while callback ran,
+ * which only overruns when every match expires
+ */
+#define TIMER_1_OVERDUE_B(num, late) \
+	(compareBDivider[(num) - HARD_TIMER_HARDWARE_COUNT] == 1 && (TIMER_1_FLAGS & TIMER_1_MATCH_B_FLAG))
 
 /**
  * sets scalar for timer 1
@@ -206,15 +306,23 @@ ISR(TIMER0_COMPA_vect) {
 		TIMER_1_SCAL |= (1 << CS12); \
 	}
 
+#if !LEAN_VECTOR(1)
 ISR(TIMER1_COMPA_vect) {
 	#if SKIP_TIMER_INDEX != 1
 		#if SKIP_TIMER_INDEX < 1
-			((void(*)())hardTimerFunctions[0])(hardTimerParams[0]);
+			HARD_TIMER_DISPATCH(0, TIMER_1_COUNTER, TIMER_1_OVERDUE)
 		#else
-			((void(*)())hardTimerFunctions[1])(hardTimerParams[1]);
+			HARD_TIMER_DISPATCH(1, TIMER_1_COUNTER, TIMER_1_OVERDUE)
 		#endif
 	#endif
 }
+#endif
+
+#if defined(HARD_TIMER_AVR_COMPARE_B) && SKIP_TIMER_INDEX != 1
+ISR(TIMER1_COMPB_vect) {
+	COMPARE_B_DISPATCH(1, TIMER_1_ALIAS)
+}
+#endif
 
 #endif
 
@@ -231,10 +339,28 @@ ISR(TIMER1_COMPA_vect) {
 #define TIMER_2_INCR TCCR2A // sets increment mode
 #define TIMER_2_SCAL TCCR2B // sets scalar mode
 #define TIMER_2_INTERR TIMSK2 // sets interrupt
+#define TIMER_2_FLAGS TIFR2 // interrupt flags
 
 #define TIMER_2_SCALAR_ENABLE ((1 << CS20) | (1 << CS21) | (1 << CS22)) // flags for timer 2 scalar
 #define TIMER_2_INTERR_ENABLE (1 << OCIE2A) // flags for timer 2 interrupt
+#define TIMER_2_MATCH_FLAG (1 << OCF2A) // flag for timer 2 compare match
+#define TIMER_2_TOGGLE_ENABLE (1 << COM2A0) // flags for timer 2 pin toggle on compare match
 #define TIMER_2_INCREM_ENABLE (1 << WGM21) // flags for timer 2 increment
+#define TIMER_2_TARGET_B OCR2B // compare B target tick value
+#define TIMER_2_INTERR_B_ENABLE (1 << OCIE2B) // flags for timer 2 compare B interrupt
+#define TIMER_2_MATCH_B_FLAG (1 << OCF2B) // flag for timer 2 compare B match
+
+/**
+ * Tests if timer 2 matched again while callback ran
+ */
+#define TIMER_2_OVERDUE(num, late) (TIMER_2_FLAGS & TIMER_2_MATCH_FLAG)
+
+/**
+ * Tests if compare B of timer 2 matched again while callback ran,
+ * which only overruns when every match expires
+ */
+#define TIMER_2_OVERDUE_B(num, late) \
+	(compareBDivider[(num) - HARD_TIMER_HARDWARE_COUNT] == 1 && (TIMER_2_FLAGS & TIMER_2_MATCH_B_FLAG))
 
 /**
  * sets scalar for timer 2
@@ -252,15 +378,23 @@ ISR(TIMER1_COMPA_vect) {
 		TIMER_2_SCAL |= (1 << CS22); \
 	}
 
+#if !LEAN_VECTOR(2)
 ISR(TIMER2_COMPA_vect) {
 	#if SKIP_TIMER_INDEX != 2
 		#if SKIP_TIMER_INDEX < 2
-			((void(*)())hardTimerFunctions[1])(hardTimerParams[1]);
+			HARD_TIMER_DISPATCH(1, TIMER_2_COUNTER, TIMER_2_OVERDUE)
 		#else
-			((void(*)())hardTimerFunctions[2])(hardTimerParams[2]);
+			HARD_TIMER_DISPATCH(2, TIMER_2_COUNTER, TIMER_2_OVERDUE)
 		#endif
 	#endif
 }
+#endif
+
+#if defined(HARD_TIMER_AVR_COMPARE_B) && SKIP_TIMER_INDEX != 2
+ISR(TIMER2_COMPB_vect) {
+	COMPARE_B_DISPATCH(2, TIMER_2_ALIAS)
+}
+#endif
 
 #endif
 
@@ -314,12 +448,15 @@ void setTimerStarted(hard_timer_enum_t timer, bool state) {
 	if (timer == HARD_TIMER_INVALID) {
 		return;
 	}
+	// ISRs clear started state of timers their callbacks stop
+	HARD_TIMER_LOCK();
 	if (state) {
 		timerStates |= (1 << timer);
 	}
 	else {
 		timerStates &= (~(1 << timer));
 	}
+	HARD_TIMER_UNLOCK();
 }
 
 /**
@@ -333,12 +470,15 @@ void setTimerClaimed(hard_timer_enum_t timer, bool state) {
 	if (timer == HARD_TIMER_INVALID) {
 		return;
 	}
+	// shares state with started state ISRs clear
+	HARD_TIMER_LOCK();
 	if (state) {
 		timerStates |= (1 << (timer + HARD_TIMER_COUNT));
 	}
 	else {
 		timerStates &= (~(1 << (timer + HARD_TIMER_COUNT)));
 	}
+	HARD_TIMER_UNLOCK();
 }
 
 /**
@@ -383,8 +523,8 @@ void getStats(hard_timer_freq_t *freq, hard_timer_enum_t timer, prescalar_enum_t
 			continue;
 		}
 
-		// ignore invalid ticks
-		if ((timertick_t)(F_CPU / (getMask(i) * *freq)) < 1) {
+		// ignore invalid ticks, compared without overflowing toggle frequencies
+		if (*freq > F_CPU / getMask(i)) {
 			continue;
 		}
 		if (calculateTicks(i, *freq) > UINT16_MAX) {
@@ -420,6 +560,37 @@ bool hardTimerClaimed(hard_timer_enum_t timer) {
 	return (!!((1 << (HARD_TIMER_COUNT + timer)) & timerStates));
 }
 
+/**
+ * Tests if hardware timer of timer is counting for compare A or B
+ * 
+ * @param timer compare A timer to test
+ * 
+ * @return if hardware timer is in use, always true for invalid timers
+ */
+bool hardwareTimerBusy(hard_timer_enum_t timer) {
+
+	if (timer == HARD_TIMER_INVALID) {
+		return true;
+	}
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (!IS_COMPARE_B(timer) && hardTimerStarted(HARD_TIMER_COMPARE_B(timer))) {
+			return true;
+		}
+	#endif
+	return hardTimerStarted(timer);
+}
+
+/**
+ * Tests if timer is kept from being picked, by a claim or a lean ISR
+ * 
+ * @param timer timer to test
+ * 
+ * @return if timer is reserved
+ */
+bool timerReserved(hard_timer_enum_t timer) {
+	return hardTimerClaimed(timer) || LEAN_TIMER(timer);
+}
+
 /**
  * Tests if given timer is available to claim
  * 
@@ -428,7 +599,8 @@ bool hardTimerClaimed(hard_timer_enum_t timer) {
  * @return if timer is available
  */
 bool availableClaim(hard_timer_enum_t timer) {
-	if (!hardTimerClaimed(timer) && !hardTimerStarted(timer)) {
+	// compare A can't be set while its compare B counts on the hardware timer
+	if (!timerReserved(timer) && !hardwareTimerBusy(timer)) {
 		setTimerClaimed(timer, true);
 		return true;
 	}
@@ -528,13 +700,13 @@ bool unclaimTimer(hard_timer_enum_t timer) {
  */
 hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t *timer, prescalar_enum_t *scalar, timertick_t *timerTicks) {
 
-	// returns started timer early
-	if (hardTimerStarted(*timer) && hardTimerClaimed(*timer)) {
+	// claimed timers are never swapped, even when only their compare B runs
+	if (hardTimerClaimed(*timer) && hardwareTimerBusy(*timer)) {
 		return HARD_TIMER_FAIL;
 	}
 
 	// gets stats for current timer
-	if (!hardTimerStarted(*timer) && *timer != HARD_TIMER_INVALID) {
+	if (!hardwareTimerBusy(*timer)) {
 		SET_FIRST_FREQ(*freq, *timer, *freq, *timer, *timerTicks, *scalar);
 		return HARD_TIMER_SLIGHTLY_OFF;
 	}
@@ -545,7 +717,7 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 	if (*freq < FREQ_MIN_8_COUNTER) {
 		// calculates slow frequencies for timer 1
 
-		if (hardTimerStarted(TIMER_1_ALIAS) || hardTimerClaimed(TIMER_1_ALIAS)) {
+		if (hardwareTimerBusy(TIMER_1_ALIAS) || timerReserved(TIMER_1_ALIAS)) {
 			// slow timer unavailable
 			return HARD_TIMER_FAIL;
 		}
@@ -567,12 +739,12 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 		hard_timer_freq_t tempFreq = *freq;
 
 		// gets timer 0
-		if (!hardTimerStarted(TIMER_0_ALIAS) && !hardTimerClaimed(TIMER_0_ALIAS)) {
+		if (!hardwareTimerBusy(TIMER_0_ALIAS) && !timerReserved(TIMER_0_ALIAS)) {
 			SET_FIRST_FREQ(*freq, *timer, tempFreq, TIMER_0_ALIAS, *timerTicks, *scalar);
 		}
 
 		// gets timer 1
-		if (!hardTimerStarted(TIMER_1_ALIAS) && !hardTimerClaimed(TIMER_1_ALIAS)) {
+		if (!hardwareTimerBusy(TIMER_1_ALIAS) && !timerReserved(TIMER_1_ALIAS)) {
 
 			if (*timer == HARD_TIMER_INVALID) {
 				// timer 0 unavailable
@@ -585,7 +757,7 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 		}
 
 		// gets timer 2
-		if (!hardTimerStarted(TIMER_2_ALIAS) && !hardTimerClaimed(TIMER_2_ALIAS)) {
+		if (!hardwareTimerBusy(TIMER_2_ALIAS) && !timerReserved(TIMER_2_ALIAS)) {
 
 			if (*timer == HARD_TIMER_INVALID) {
 				// timer 0 and 1 unavailable
@@ -621,15 +793,109 @@ bool hardTimerStarted(hard_timer_enum_t timer) {
  * @param num timer id
  */
 #define CANCEL_HARD_TIMER(num) \
-	cli(); \
+	HARD_TIMER_LOCK(); \
 	HARD_TIMER_CONCATENATE3(TIMER_, num, _SCAL) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _SCALAR_ENABLE); \
 	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE); \
-	sei()
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _COMP) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _TOGGLE_ENABLE); \
+	HARD_TIMER_UNLOCK()
+
+#if SKIP_TIMER_INDEX != 0
+	#define HARD_TIMER0_HARDWARE 0 // hardware timer of HARD_TIMER0
+#else
+	#define HARD_TIMER0_HARDWARE 1 // hardware timer of HARD_TIMER0
+#endif
+#if SKIP_TIMER_INDEX < 1
+	#define HARD_TIMER1_HARDWARE 2 // hardware timer of HARD_TIMER1
+#else
+	#define HARD_TIMER1_HARDWARE 1 // hardware timer of HARD_TIMER1
+#endif
+#if SKIP_TIMER_INDEX < 2
+	#define HARD_TIMER2_HARDWARE 3 // hardware timer of HARD_TIMER2
+#else
+	#define HARD_TIMER2_HARDWARE 2 // hardware timer of HARD_TIMER2
+#endif
+
+/**
+ * Runs macro on hardware timer of compare A timer
+ * 
+ * @param timer compare A timer
+ * @param ACTION macro taking hardware timer number
+ */
+#if HARD_TIMER_HARDWARE_COUNT > 2
+	#define FOR_HARDWARE_TIMER(timer, ACTION) \
+		if ((timer) == HARD_TIMER0) { ACTION(HARD_TIMER0_HARDWARE); } \
+		else if ((timer) == HARD_TIMER1) { ACTION(HARD_TIMER1_HARDWARE); } \
+		else if ((timer) == HARD_TIMER2) { ACTION(HARD_TIMER2_HARDWARE); }
+#else
+	#define FOR_HARDWARE_TIMER(timer, ACTION) \
+		if ((timer) == HARD_TIMER0) { ACTION(HARD_TIMER0_HARDWARE); } \
+		else if ((timer) == HARD_TIMER1) { ACTION(HARD_TIMER1_HARDWARE); }
+#endif
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Stops compare A interrupt while compare B keeps hardware timer counting
+ * 
+ * @param num hardware timer number
+ */
+#define CANCEL_COMPARE_A(num) \
+	HARD_TIMER_LOCK(); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _COMP) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _TOGGLE_ENABLE); \
+	HARD_TIMER_UNLOCK()
+
+/**
+ * Stops compare B interrupt
+ * 
+ * @param num hardware timer number
+ */
+#define CANCEL_COMPARE_B(num) \
+	HARD_TIMER_LOCK(); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_B_ENABLE); \
+	HARD_TIMER_UNLOCK()
+
+/**
+ * Cancels compare B timer, stopping its hardware timer if compare A is stopped
+ * 
+ * @param timer compare B timer
+ * 
+ * @return if timer was cancelled
+ */
+bool cancelCompareB(hard_timer_enum_t timer) {
+
+	if (!hardTimerStarted(timer)) {
+		return false;
+	}
+	hard_timer_enum_t parent = (hard_timer_enum_t)(timer - HARD_TIMER_HARDWARE_COUNT);
+	FOR_HARDWARE_TIMER(parent, CANCEL_COMPARE_B);
+	if (!hardTimerStarted(parent)) {
+		FOR_HARDWARE_TIMER(parent, CANCEL_HARD_TIMER);
+	}
+	setTimerStarted(timer, false);
+	HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
+	return true;
+}
+
+#endif
 
 bool cancelHardTimer(hard_timer_enum_t timer) {
 
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(timer)) {
+			return cancelCompareB(timer);
+		}
+		if (hardTimerStarted(timer) && hardTimerStarted(HARD_TIMER_COMPARE_B(timer))) {
+			// compare B still needs hardware timer counting
+			FOR_HARDWARE_TIMER(timer, CANCEL_COMPARE_A);
+			setTimerStarted(timer, false);
+			HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
+			return true;
+		}
+	#endif
+
 	if (hardTimerStarted(timer)) {
-		#if HARD_TIMER_COUNT > 0
+		#if HARD_TIMER_HARDWARE_COUNT > 0
 			if (timer == HARD_TIMER0) {
 				#if SKIP_TIMER_INDEX != 0
 					CANCEL_HARD_TIMER(0);
@@ -638,7 +904,7 @@ bool cancelHardTimer(hard_timer_enum_t timer) {
 				#endif
 			}
 		#endif
-		#if HARD_TIMER_COUNT > 1
+		#if HARD_TIMER_HARDWARE_COUNT > 1
 			else if (timer == HARD_TIMER1) {
 				#if SKIP_TIMER_INDEX < 1
 					CANCEL_HARD_TIMER(2);
@@ -647,7 +913,7 @@ bool cancelHardTimer(hard_timer_enum_t timer) {
 				#endif
 			}
 		#endif
-		#if HARD_TIMER_COUNT > 2
+		#if HARD_TIMER_HARDWARE_COUNT > 2
 			else if (timer == HARD_TIMER2) {
 				#if SKIP_TIMER_INDEX < 2
 					CANCEL_HARD_TIMER(3);
@@ -657,12 +923,370 @@ bool cancelHardTimer(hard_timer_enum_t timer) {
 			}
 		#endif
 		setTimerStarted(timer, false);
+		HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
 		return true;
 	}
 
 	return false;
 }
 
+/**
+ * Reads counter of hardware timer including pending compare match
+ * 
+ * @warning must be called with interrupts disabled
+ * 
+ * @param num hardware timer number
+ * @param ticks variable to store ticks since last expiry in
+ * @param period ticks between expiries
+ */
+#define GET_HARD_TIMER_TICKS(num, ticks, period) \
+	(ticks) = HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER); \
+	if (HARD_TIMER_CONCATENATE3(TIMER_, num, _FLAGS) & HARD_TIMER_CONCATENATE3(TIMER_, num, _MATCH_FLAG)) { \
+		(ticks) = HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) + (period); \
+	}
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Reads ticks since last compare B match including pending match
+ * 
+ * @warning must be called with interrupts disabled
+ * @warning stores in ticks and reads parentPeriod of caller
+ * 
+ * @param num hardware timer number
+ */
+#define GET_COMPARE_B_TICKS(num) \
+	ticks = COMPARE_B_LATE(num); \
+	if (HARD_TIMER_CONCATENATE3(TIMER_, num, _FLAGS) & HARD_TIMER_CONCATENATE3(TIMER_, num, _MATCH_B_FLAG)) { \
+		ticks += parentPeriod; \
+	}
+
+/**
+ * Gets ticks of compare B timer in its deadline domain
+ * 
+ * @param timer compare B timer
+ * 
+ * @return ticks of timer
+ */
+hard_timer_tick_t getCompareBTicks(hard_timer_enum_t timer) {
+
+	hard_timer_enum_t parent = (hard_timer_enum_t)(timer - HARD_TIMER_HARDWARE_COUNT);
+	hard_timer_tick_t ticks = 0;
+
+	HARD_TIMER_LOCK();
+	hard_timer_tick_t deadline = hardTimerInfo[timer].deadline;
+	hard_timer_tick_t period = hardTimerInfo[timer].period;
+	hard_timer_tick_t parentPeriod = hardTimerInfo[parent].period;
+	FOR_HARDWARE_TIMER(parent, GET_COMPARE_B_TICKS);
+	// whole compare A periods since matches counted down from divider
+	ticks += (hard_timer_tick_t)(compareBDivider[parent] - compareBCount[parent]) * parentPeriod;
+	HARD_TIMER_UNLOCK();
+
+	return deadline - period + ticks;
+}
+
+#endif
+
+hard_timer_tick_t getHardTimerTicks(hard_timer_enum_t timer) {
+
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(timer)) {
+			return getCompareBTicks(timer);
+		}
+	#endif
+
+	hard_timer_tick_t ticks = 0;
+
+	HARD_TIMER_LOCK();
+	hard_timer_tick_t deadline = hardTimerInfo[timer].deadline;
+	hard_timer_tick_t period = hardTimerInfo[timer].period;
+
+	#if HARD_TIMER_HARDWARE_COUNT > 0
+		if (timer == HARD_TIMER0) {
+			#if SKIP_TIMER_INDEX != 0
+				GET_HARD_TIMER_TICKS(0, ticks, period);
+			#else
+				GET_HARD_TIMER_TICKS(1, ticks, period);
+			#endif
+		}
+	#endif
+	#if HARD_TIMER_HARDWARE_COUNT > 1
+		else if (timer == HARD_TIMER1) {
+			#if SKIP_TIMER_INDEX < 1
+				GET_HARD_TIMER_TICKS(2, ticks, period);
+			#else
+				GET_HARD_TIMER_TICKS(1, ticks, period);
+			#endif
+		}
+	#endif
+	#if HARD_TIMER_HARDWARE_COUNT > 2
+		else if (timer == HARD_TIMER2) {
+			#if SKIP_TIMER_INDEX < 2
+				GET_HARD_TIMER_TICKS(3, ticks, period);
+			#else
+				GET_HARD_TIMER_TICKS(2, ticks, period);
+			#endif
+		}
+	#endif
+	HARD_TIMER_UNLOCK();
+
+	// counter clears on compare match
+	return deadline - period + ticks;
+}
+
+/**
+ * Sets target of hardware timer
+ * 
+ * @param num hardware timer number
+ * @param period ticks between expiries
+ * @param max largest target of timer
+ */
+#define SET_HARD_TIMER_PERIOD(num, period, max) \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET) = (period) - 1 > (max) ? (max) : (period) - 1
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Gets compare A period of hardware timer
+ * 
+ * @param num hardware timer number
+ */
+#define GET_COMPARE_A_PERIOD(num) \
+	target = (hard_timer_tick_t)HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET) + 1
+
+/**
+ * Tests if compare B still matches in the current compare A period
+ * 
+ * @param num hardware timer number
+ */
+#define GET_COMPARE_B_PENDING(num) \
+	pending = HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) < HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B)
+
+/**
+ * Keeps compare B target within compare A period
+ * 
+ * @param num hardware timer number
+ */
+#define CLAMP_COMPARE_B(num) \
+	if (HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B) > HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET)) { \
+		HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B) = HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET); \
+	}
+
+/**
+ * Gets compare A period currently set in hardware
+ * 
+ * @param parent compare A timer
+ * 
+ * @return ticks between compare A matches
+ */
+hard_timer_tick_t getCompareAPeriod(hard_timer_enum_t parent) {
+	hard_timer_tick_t target = 0;
+	FOR_HARDWARE_TIMER(parent, GET_COMPARE_A_PERIOD);
+	return target;
+}
+
+/**
+ * Moves running compare B timer with a new compare A period
+ * 
+ * @param parent compare A timer whose target changed
+ * @param before compare A period before the change
+ * 
+ * @warning must be called with interrupts disabled
+ */
+void followCompareA(hard_timer_enum_t parent, hard_timer_tick_t before) {
+
+	hard_timer_enum_t timer = HARD_TIMER_COMPARE_B(parent);
+	if (!hardTimerStarted(timer)) {
+		return;
+	}
+
+	bool pending = false;
+	FOR_HARDWARE_TIMER(parent, CLAMP_COMPARE_B);
+	FOR_HARDWARE_TIMER(parent, GET_COMPARE_B_PENDING);
+	hard_timer_tick_t target = getCompareAPeriod(parent);
+
+	// matches left in later periods move by the change, a match still due in this one doesn't
+	uint16_t moved = compareBCount[parent] - (pending ? 1 : 0);
+	hardTimerInfo[timer].deadline += (target - before) * moved;
+	hardTimerInfo[timer].period = target * compareBDivider[parent];
+}
+
+#endif
+
+void setHardTimerPeriod(hard_timer_enum_t timer, hard_timer_tick_t period) {
+
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(timer)) {
+			// follows period of compare A
+			return;
+		}
+		// compare B children move with the new period in the same critical section
+		HARD_TIMER_LOCK();
+		hard_timer_tick_t before = getCompareAPeriod(timer);
+	#endif
+
+	#if HARD_TIMER_HARDWARE_COUNT > 0
+		if (timer == HARD_TIMER0) {
+			#if SKIP_TIMER_INDEX != 0
+				SET_HARD_TIMER_PERIOD(0, period, UINT8_MAX);
+			#else
+				SET_HARD_TIMER_PERIOD(1, period, UINT16_MAX);
+			#endif
+		}
+	#endif
+	#if HARD_TIMER_HARDWARE_COUNT > 1
+		else if (timer == HARD_TIMER1) {
+			#if SKIP_TIMER_INDEX < 1
+				SET_HARD_TIMER_PERIOD(2, period, UINT8_MAX);
+			#else
+				SET_HARD_TIMER_PERIOD(1, period, UINT16_MAX);
+			#endif
+		}
+	#endif
+	#if HARD_TIMER_HARDWARE_COUNT > 2
+		else if (timer == HARD_TIMER2) {
+			#if SKIP_TIMER_INDEX < 2
+				SET_HARD_TIMER_PERIOD(3, period, UINT8_MAX);
+			#else
+				SET_HARD_TIMER_PERIOD(2, period, UINT8_MAX);
+			#endif
+		}
+	#endif
+
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		followCompareA(timer, before);
+		HARD_TIMER_UNLOCK();
+	#endif
+}
+
+hard_timer_tick_t getHardTimerPeriodMax(hard_timer_enum_t timer) {
+	// only timer 1 has a 16 bit counter
+	if (timer == TIMER_1_ALIAS) {
+		return (hard_timer_tick_t)UINT16_MAX + 1;
+	}
+	return (hard_timer_tick_t)UINT8_MAX + 1;
+}
+
+void haltHardTimer(hard_timer_enum_t timer) {
+	// cancelling only writes timer registers and keeps interrupts off in ISRs
+	cancelHardTimer(timer);
+}
+
+#ifdef HARD_TIMER_AVR_NESTED
+
+uint8_t preemptibleTimers = 0U; // timers whose callbacks run with interrupts enabled
+hard_timer_priority_t timerPriorities[HARD_TIMER_COUNT]; // priorities timers were set with
+uint8_t nestMasked[HARD_TIMER_COUNT]; // timers masked while callback of timer runs
+
+/**
+ * Sets if callbacks of timer can be preempted from its priority
+ * 
+ * @param timer timer to set
+ * @param priority priority timer is set with
+ */
+void setTimerPreemptible(hard_timer_enum_t timer, hard_timer_priority_t priority) {
+	HARD_TIMER_LOCK();
+	timerPriorities[timer] = priority;
+	if (priority < HARD_TIMER_AVR_PREEMPT_PRIORITY) {
+		preemptibleTimers |= (1 << timer);
+	}
+	else {
+		preemptibleTimers &= ~(1 << timer);
+	}
+	HARD_TIMER_UNLOCK();
+}
+
+/**
+ * Masks compare A or B interrupt of hardware timer, storing if it was enabled
+ * 
+ * @param num hardware timer number
+ */
+#define NEST_MASK(num) \
+	enabled = (HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) & HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE)) != 0; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE)
+#define NEST_MASK_B(num) \
+	enabled = (HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) & HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_B_ENABLE)) != 0; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) &= ~HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_B_ENABLE)
+
+/**
+ * Unmasks compare A or B interrupt of hardware timer
+ * 
+ * @param num hardware timer number
+ */
+#define NEST_UNMASK(num) HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE)
+#define NEST_UNMASK_B(num) HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_B_ENABLE)
+
+/**
+ * Masks interrupt of timer
+ * 
+ * @param timer timer to mask
+ * 
+ * @return if interrupt was enabled
+ */
+bool maskNestedTimer(hard_timer_enum_t timer) {
+	bool enabled = false;
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(timer)) {
+			FOR_HARDWARE_TIMER(timer - HARD_TIMER_HARDWARE_COUNT, NEST_MASK_B);
+			return enabled;
+		}
+	#endif
+	FOR_HARDWARE_TIMER(timer, NEST_MASK);
+	return enabled;
+}
+
+/**
+ * Unmasks interrupt of timer
+ * 
+ * @param timer timer to unmask
+ */
+void unmaskNestedTimer(hard_timer_enum_t timer) {
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(timer)) {
+			FOR_HARDWARE_TIMER(timer - HARD_TIMER_HARDWARE_COUNT, NEST_UNMASK_B);
+			return;
+		}
+	#endif
+	FOR_HARDWARE_TIMER(timer, NEST_UNMASK);
+}
+
+bool nestHardTimerEnter(uint8_t num) {
+
+	if ((preemptibleTimers & (1 << num)) == 0) {
+		return false;
+	}
+	// only strictly higher priorities preempt, own interrupt included so callback never runs inside itself
+	uint8_t masked = 0U;
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (timerPriorities[i] <= timerPriorities[num] && maskNestedTimer((hard_timer_enum_t)i)) {
+			masked |= (1 << i);
+		}
+	}
+	nestMasked[num] = masked;
+	sei();
+	return true;
+}
+
+void nestHardTimerExit(uint8_t num) {
+
+	cli();
+	uint8_t masked = nestMasked[num];
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		// timers cancelled while masked stay masked for good
+		if ((masked & (1 << i)) != 0 && hardTimerStarted((hard_timer_enum_t)i)) {
+			unmaskNestedTimer((hard_timer_enum_t)i);
+		}
+	}
+}
+
+#define SET_TIMER_PREEMPTIBLE(timer, priority) setTimerPreemptible(timer, priority) // stores if callbacks can be preempted
+
+#else
+
+#define SET_TIMER_PREEMPTIBLE(timer, priority) // callbacks always run with interrupts disabled
+
+#endif
+
 /**
  * Sets hard timer
  * 
@@ -679,7 +1303,139 @@ bool cancelHardTimer(hard_timer_enum_t timer) {
 	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_ENABLE); \
 	sei()
 
-bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Gets compare A matches per compare B expiry closest to frequency
+ * 
+ * @param parent compare A timer
+ * @param freq pointer to desired frequency, changed to achieved frequency
+ * 
+ * @return compare A periods per compare B expiry
+ */
+uint16_t getCompareBDivider(hard_timer_enum_t parent, hard_timer_freq_t *freq) {
+
+	hard_timer_freq_t parentFreq = hardTimerInfo[parent].tickFreq / hardTimerInfo[parent].period;
+	hard_timer_freq_t divider = (parentFreq + *freq / 2) / *freq;
+
+	if (divider == 0) {
+		divider = 1;
+	}
+	else if (divider > UINT16_MAX) {
+		divider = UINT16_MAX;
+	}
+	*freq = parentFreq / divider;
+	return (uint16_t)divider;
+}
+
+/**
+ * Sets compare B target and enables its interrupt
+ * 
+ * @warning must be called with interrupts disabled
+ * @warning reads phase and stores in ticks of caller
+ * 
+ * @param num hardware timer number
+ */
+#define SET_COMPARE_B(num) \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET_B) = phase; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _FLAGS) = HARD_TIMER_CONCATENATE3(TIMER_, num, _MATCH_B_FLAG); \
+	ticks = COMPARE_B_LATE(num); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _INTERR_B_ENABLE)
+
+/**
+ * Sets compare B timer to sub-multiple of its running compare A timer
+ * 
+ * @param timer compare B timer
+ * @param freq pointer to desired frequency, changed to achieved frequency
+ * @param function function to call on expiry
+ * @param params parameters to pass to function
+ * @param priority priority to run timer at
+ * @param type hard_timer_function_type_t of function
+ * 
+ * @return if timer was set
+ */
+bool setCompareB(hard_timer_enum_t timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type) {
+
+	hard_timer_enum_t parent = (hard_timer_enum_t)(timer - HARD_TIMER_HARDWARE_COUNT);
+
+	if (!hardTimerStarted(parent) || hardTimerStarted(timer)) {
+		return false;
+	}
+
+	uint16_t divider = getCompareBDivider(parent, freq);
+	hard_timer_tick_t parentPeriod = hardTimerInfo[parent].period;
+	timertick_t phase = compareBPhase[parent];
+	hard_timer_tick_t ticks = 0;
+
+	if (phase >= parentPeriod) {
+		phase = parentPeriod - 1;
+	}
+
+	setHardTimerFunctionTyped(timer, function, params, type);
+	SET_TIMER_PREEMPTIBLE(timer, priority);
+
+	HARD_TIMER_LOCK();
+	compareBDivider[parent] = divider;
+	compareBCount[parent] = divider;
+	FOR_HARDWARE_TIMER(parent, SET_COMPARE_B);
+	// deadline domain starts now, one partial compare A period before the first match
+	resetHardTimerInfo(timer, (hard_timer_tick_t)0 - ticks, parentPeriod * divider, hardTimerInfo[parent].tickFreq);
+	setTimerStarted(timer, true);
+	HARD_TIMER_UNLOCK();
+
+	return true;
+}
+
+/**
+ * Sets closest free compare B timer of running compare A timers
+ * 
+ * @param timer pointer to store set timer in
+ * @param freq pointer to desired frequency, changed to achieved frequency
+ * @param function function to call on expiry
+ * @param params parameters to pass to function
+ * @param priority priority to run timer at
+ * @param type hard_timer_function_type_t of function
+ * 
+ * @return if timer was set
+ */
+bool setAnyCompareB(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type) {
+
+	hard_timer_enum_t bestTimer = HARD_TIMER_INVALID;
+	hard_timer_freq_t bestError = 0;
+
+	for (uint8_t i = 0; i < HARD_TIMER_HARDWARE_COUNT; i++) {
+		hard_timer_enum_t channel = HARD_TIMER_COMPARE_B(i);
+		if (!hardTimerStarted(i) || hardTimerStarted(channel) || hardTimerClaimed(channel)) {
+			continue;
+		}
+		hard_timer_freq_t calcFreq = *freq;
+		getCompareBDivider(i, &calcFreq);
+		hard_timer_freq_t error = calcFreq > *freq ? calcFreq - *freq : *freq - calcFreq;
+		if (bestTimer == HARD_TIMER_INVALID || error < bestError) {
+			bestTimer = channel;
+			bestError = error;
+		}
+	}
+
+	if (bestTimer == HARD_TIMER_INVALID) {
+		return false;
+	}
+	*timer = bestTimer;
+	return setCompareB(bestTimer, freq, function, params, priority, type);
+}
+
+bool setHardTimerPhase(hard_timer_enum_t timer, hard_timer_tick_t phase) {
+
+	if (!IS_COMPARE_B(timer) || timer >= HARD_TIMER_COUNT) {
+		return false;
+	}
+	compareBPhase[timer - HARD_TIMER_HARDWARE_COUNT] = phase > UINT16_MAX ? UINT16_MAX : (timertick_t)phase;
+	return true;
+}
+
+#endif
+
+bool setHardTimerTyped(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type) {
 
 	if (function == NULL || freq == NULL || timer == NULL) {
 		return false;
@@ -688,18 +1444,34 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 		return false;
 	}
 
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(*timer) && !hardTimerStarted(*timer)) {
+			return setCompareB(*timer, freq, function, params, priority, type);
+		}
+	#endif
+
 	prescalar_enum_t scalar;
 	timertick_t timerTicks;
 
 	if (getHardTimerStats(freq, timer, &scalar, &timerTicks) == HARD_TIMER_FAIL) {
+		#ifdef HARD_TIMER_AVR_COMPARE_B
+			if (*timer == HARD_TIMER_INVALID) {
+				// hardware timers are taken, so shares one through compare B
+				return setAnyCompareB(timer, freq, function, params, priority, type);
+			}
+		#endif
 		return false;
 	}
 
 	if (!hardTimerStarted(*timer)) {
 
-		setHardTimerFunction(*timer, function, params);
+		setHardTimerFunctionTyped(*timer, function, params, type);
+		SET_TIMER_PREEMPTIBLE(*timer, priority);
 
-		#if HARD_TIMER_COUNT > 0
+		// counter clears on compare match
+		resetHardTimerInfo(*timer, 0, (hard_timer_tick_t)timerTicks + 1, F_CPU / getMask(scalar));
+
+		#if HARD_TIMER_HARDWARE_COUNT > 0
 			if (*timer == HARD_TIMER0) {
 				#if SKIP_TIMER_INDEX != 0
 					SET_HARD_TIMER(0, scalar, timerTicks, function, params);
@@ -708,7 +1480,7 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 				#endif
 			}
 		#endif
-		#if HARD_TIMER_COUNT > 1
+		#if HARD_TIMER_HARDWARE_COUNT > 1
 			else if (*timer == HARD_TIMER1) {
 				#if SKIP_TIMER_INDEX < 1
 					SET_HARD_TIMER(2, scalar, timerTicks, function, params);
@@ -717,7 +1489,7 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 				#endif
 			}
 		#endif
-		#if HARD_TIMER_COUNT > 2
+		#if HARD_TIMER_HARDWARE_COUNT > 2
 			else if (*timer == HARD_TIMER2) {
 				#if SKIP_TIMER_INDEX < 2
 					SET_HARD_TIMER(3, scalar, timerTicks, function, params);
@@ -734,4 +1506,86 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 	return false;
 }
 
+/**
+ * Sets hard timer to toggle its output compare pin without interrupts
+ * 
+ * @param num timer number
+ */
+#define SET_HARD_TIMER_TOGGLE(num, scalar, timerTicks) \
+	cli(); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _COMP) = 0; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _WAVEFORM) = 0; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _COUNTER) = 0; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _TARGET) = timerTicks; \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _INCR) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _INCREM_ENABLE); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _COMP) |= HARD_TIMER_CONCATENATE3(TIMER_, num, _TOGGLE_ENABLE); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _PIN_DDR) |= (1 << HARD_TIMER_CONCATENATE3(TIMER_, num, _PIN_BIT)); \
+	HARD_TIMER_CONCATENATE3(TIMER_, num, _SET_SCALAR)(scalar); \
+	sei()
+
+bool setHardTimerToggle(hard_timer_enum_t *timer, hard_timer_freq_t *freq) {
+
+	if (freq == NULL || timer == NULL) {
+		return false;
+	}
+	if (*freq == (hard_timer_freq_t)0 || *freq > HARD_TIMER_TOGGLE_FREQ_MAX) {
+		return false;
+	}
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		if (IS_COMPARE_B(*timer)) {
+			// only compare A drives a pin in this mode
+			return false;
+		}
+	#endif
+
+	// pin toggles twice per period
+	hard_timer_freq_t toggleFreq = *freq * 2;
+	prescalar_enum_t scalar;
+	timertick_t timerTicks;
+
+	if (getHardTimerStats(&toggleFreq, timer, &scalar, &timerTicks) == HARD_TIMER_FAIL) {
+		return false;
+	}
+
+	if (!hardTimerStarted(*timer)) {
+
+		// counter clears on compare match
+		resetHardTimerInfo(*timer, 0, (hard_timer_tick_t)timerTicks + 1, F_CPU / getMask(scalar));
+
+		#if HARD_TIMER_HARDWARE_COUNT > 0
+			if (*timer == HARD_TIMER0) {
+				#if SKIP_TIMER_INDEX != 0
+					SET_HARD_TIMER_TOGGLE(0, scalar, timerTicks);
+				#else
+					SET_HARD_TIMER_TOGGLE(1, scalar, timerTicks);
+				#endif
+			}
+		#endif
+		#if HARD_TIMER_HARDWARE_COUNT > 1
+			else if (*timer == HARD_TIMER1) {
+				#if SKIP_TIMER_INDEX < 1
+					SET_HARD_TIMER_TOGGLE(2, scalar, timerTicks);
+				#else
+					SET_HARD_TIMER_TOGGLE(1, scalar, timerTicks);
+				#endif
+			}
+		#endif
+		#if HARD_TIMER_HARDWARE_COUNT > 2
+			else if (*timer == HARD_TIMER2) {
+				#if SKIP_TIMER_INDEX < 2
+					SET_HARD_TIMER_TOGGLE(3, scalar, timerTicks);
+				#else
+					SET_HARD_TIMER_TOGGLE(2, scalar, timerTicks);
+				#endif
+			}
+		#endif
+
+		*freq = calculateFreq(scalar, timerTicks) / 2;
+		setTimerStarted(*timer, true);
+		return true;
+	}
+
+	return false;
+}
+
 #endif
\ No newline at end of file
@@ -38,4 +38,11 @@
 
 #ifndef OVERRIDE_ARDUINO_TIMER
 	#define SKIP_TIMER_INDEX 0
-#endif
\ No newline at end of file
+#endif
+
+#define TIMER_0_PIN_DDR DDRD // direction register of OC0A, Arduino pin 6
+#define TIMER_0_PIN_BIT DDD6 // direction bit of OC0A
+#define TIMER_1_PIN_DDR DDRB // direction register of OC1A, Arduino pin 9
+#define TIMER_1_PIN_BIT DDB1 // direction bit of OC1A
+#define TIMER_2_PIN_DDR DDRB // direction register of OC2A, Arduino pin 11
+#define TIMER_2_PIN_BIT DDB3 // direction bit of OC2A
\ No newline at end of file
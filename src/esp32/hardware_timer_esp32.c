@@ -21,10 +21,11 @@
  * 
  * freq = desired frequency (Hz)
  * 
- * freq = APB_CLK / (scalar * timerTicks)
+ * freq = tickFreq / timerTicks
+ * 
+ * tickFreq = APB_CLK / 2 = 40,000,000Hz
  * 
  * 64-bit counter
- * 16-bit scalar
  */
 
 #include "../private/hardware_timer_priv.h"
@@ -36,7 +37,24 @@
 #include <esp_system.h>
 
 #define TIMER_COUNT_ZERO 0U // value for setting timer tick count to 0
-#define SCALAR_MAX UINT16_MAX // max value for timer scalar
+
+#ifdef HARD_TIMER_IRAM_SAFE
+	#include <sdkconfig.h>
+	#include <esp_intr_alloc.h>
+
+	// interrupt flags for running ISR while flash cache is disabled
+	#define HARD_TIMER_INTR_FLAGS ESP_INTR_FLAG_IRAM
+
+	#if ESP_IDF_VERSION_MAJOR == 5 && !defined(CONFIG_GPTIMER_ISR_IRAM_SAFE)
+		#warning "HARD_TIMER_IRAM_SAFE requires CONFIG_GPTIMER_ISR_IRAM_SAFE in sdkconfig"
+	#endif
+	// ISRs read counts, change alarms and stop timers with gptimer control functions
+	#if ESP_IDF_VERSION_MAJOR == 5 && !defined(CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM)
+		#warning "HARD_TIMER_IRAM_SAFE requires CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM in sdkconfig"
+	#endif
+#else
+	#define HARD_TIMER_INTR_FLAGS 0 // interrupt flags for ISR
+#endif
 
 typedef uint16_t prescalar_t; // pre scalar type
 typedef uint64_t timertick_t; // timer tick type
@@ -114,35 +132,39 @@ gptimer_handle_t *timers[] = {
 
 typedef gptimer_handle_t** timer_ptr_t;
 
-// gptimer requires this as minimum freq
-#define HARD_TIMER_FREQ_MIN 1221
-
 #endif
 
+#define TIMER_DIVIDER 2 // smallest APB clock divider of timers
+#define TIMER_TICK_FREQ (APB_CLK_FREQ / TIMER_DIVIDER) // ticks per second of timers
+
 uint8_t claimed = 0U; // stores whether timers were claimed or not
+HARD_TIMER_ISR_DATA uint8_t halted = 0U; // stores timers stopped by their callback, still holding a driver
+
+#define PRIORITY_LEVELS 3 // interrupt levels handlers written in c can run at
 
 /**
  * Scales input priority
  * 
+ * Lowest quarter of priorities lets the driver pick the lowest free
+ * level, the rest map evenly onto levels 1 to 3
+ * 
  * @param priority of type hard_timer_priority_t
  * 
  * @note function can only run up to priority 'ESP_INTR_FLAG_LEVEL3' since functions are in c
  * 
- * @return priority flag for 'intr_alloc_flags' when calling 'timer_isr_callback_add'
+ * @return priority flag for 'intr_alloc_flags' when calling 'timer_isr_callback_add',
+ * or level for 'intr_priority' of gptimer
  */
 int setPriority(hard_timer_priority_t priority) {
-	#ifdef PLATFORMIO
-		// use input priority for PlatformIO
-		int adjustment = priority / (UINT8_MAX / 3);
-		#if ESP_IDF_VERSION_MAJOR == 4
-			return (1 << adjustment);
-		#elif ESP_IDF_VERSION_MAJOR == 5
-			return adjustment;
-		#else
+	int level = priority * (PRIORITY_LEVELS + 1) / (UINT8_MAX + 1);
+	#if ESP_IDF_VERSION_MAJOR == 4
+		if (level == 0) {
 			return 0;
-		#endif
+		}
+		return ESP_INTR_FLAG_LEVEL1 << (level - 1);
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		return level;
 	#else
-		// use default priority with esp-idf
 		return 0;
 	#endif
 }
@@ -154,7 +176,7 @@ int setPriority(hard_timer_priority_t priority) {
  * 
  * @return pointer to timer selected
  */
-timer_ptr_t getTimer(hard_timer_enum_t timer) {
+timer_ptr_t HARD_TIMER_ISR_ATTR(getTimer) getTimer(hard_timer_enum_t timer) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return NULL;
@@ -235,31 +257,19 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 
 	hard_timer_status_t status = HARD_TIMER_OK;
 
-	// freq doesn't divide evenly into APB_CLK
-	if (APB_CLK_FREQ % *freq != 0) {
+	// freq doesn't divide evenly into tick frequency
+	if (TIMER_TICK_FREQ % *freq != 0) {
 		status = HARD_TIMER_SLIGHTLY_OFF;
 	}
 
-	// scalar * timerTicks = APB_CLK / freq
-	hard_timer_freq_t target = APB_CLK_FREQ / *freq;
-
-	if (target <= SCALAR_MAX) {
-		// scalar within max value
-		*scalar = (prescalar_t)target;
+	// counts at the highest rate APB allows, so periods have ticks to trim and move by
+	*scalar = TIMER_DIVIDER;
+	*timerTicks = ((timertick_t)TIMER_TICK_FREQ + *freq / 2) / *freq;
+	if (*timerTicks == 0) {
 		*timerTicks = 1;
 	}
-	else {
-		// scalar not within max value
-		*scalar = 1;
-		*timerTicks = (timertick_t)target;
-
-		while (*timerTicks % 2 == 0 && *scalar * 2 <= SCALAR_MAX) {
-			*timerTicks /= 2;
-			*scalar *= 2;
-		}
-	}
 
-	*freq = APB_CLK_FREQ / (*scalar * *timerTicks);
+	*freq = TIMER_TICK_FREQ / *timerTicks;
 
 	if ((!hardTimerClaimed(*timer) && hardTimerStarted(*timer)) || *timer == HARD_TIMER_INVALID) {
 		*timer = getNextTimer();
@@ -272,7 +282,7 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 	return status;
 }
 
-bool hardTimerStarted(hard_timer_enum_t timer) {
+bool HARD_TIMER_ISR_ATTR(hardTimerStarted) hardTimerStarted(hard_timer_enum_t timer) {
 
 	timer_ptr_t timerPtr = getTimer(timer);
 
@@ -280,6 +290,10 @@ bool hardTimerStarted(hard_timer_enum_t timer) {
 		return false;
 	}
 
+	if ((halted & (1U << timer)) != 0U) {
+		return false;
+	}
+
 	#if ESP_IDF_VERSION_MAJOR == 4
 		if (*timerPtr != NULL) {
 			return true;
@@ -293,39 +307,123 @@ bool hardTimerStarted(hard_timer_enum_t timer) {
 	return false;
 }
 
-bool cancelHardTimer(hard_timer_enum_t timer) {
-	
-	if (hardTimerStarted(timer)) {
+hard_timer_tick_t HARD_TIMER_ISR_ATTR(getHardTimerTicks) getHardTimerTicks(hard_timer_enum_t timer) {
 
-		timer_ptr_t timerPtr = getTimer(timer);
+	timer_ptr_t timerPtr = &timers[timer];
+	uint64_t count = 0;
 
-		#if ESP_IDF_VERSION_MAJOR == 4
-			// cancels timer
-			timer_set_alarm((*timerPtr) -> group, (*timerPtr) -> num, false);
-			timer_pause((*timerPtr) -> group, (*timerPtr) -> num);
-			timer_set_counter_value((*timerPtr) -> group, (*timerPtr) -> num, TIMER_COUNT_ZERO);
+	HARD_TIMER_LOCK();
+	hard_timer_tick_t deadline = hardTimerInfo[timer].deadline;
+	hard_timer_tick_t period = hardTimerInfo[timer].period;
+	#if ESP_IDF_VERSION_MAJOR == 4
+		count = timer_group_get_counter_value_in_isr((*timerPtr) -> group, (*timerPtr) -> num);
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		gptimer_get_raw_count(**timerPtr, &count);
+	#endif
+	HARD_TIMER_UNLOCK();
 
-			// deconstructs timer
-			timer_isr_callback_remove((*timerPtr) -> group, (*timerPtr) -> num);
-			timer_deinit((*timerPtr) -> group, (*timerPtr) -> num);
+	// counter reloads on alarm
+	return deadline - period + count;
+}
 
-			*timerPtr = NULL;
-			return true;
-		#elif ESP_IDF_VERSION_MAJOR == 5
+void HARD_TIMER_ISR_ATTR(setHardTimerPeriod) setHardTimerPeriod(hard_timer_enum_t timer, hard_timer_tick_t period) {
+
+	timer_ptr_t timerPtr = &timers[timer];
+
+	#if ESP_IDF_VERSION_MAJOR == 4
+		timer_group_set_alarm_value_in_isr((*timerPtr) -> group, (*timerPtr) -> num, period);
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		gptimer_alarm_config_t configAlarm = {
+			.reload_count = 0,
+			.alarm_count = period,
+			.flags.auto_reload_on_alarm = true,
+		};
+		gptimer_set_alarm_action(**timerPtr, &configAlarm);
+	#endif
+}
 
+hard_timer_tick_t HARD_TIMER_ISR_ATTR(getHardTimerPeriodMax) getHardTimerPeriodMax(hard_timer_enum_t timer) {
+	// alarm value is as wide as the counter
+	return (hard_timer_tick_t)UINT64_MAX;
+}
+
+void HARD_TIMER_ISR_ATTR(haltHardTimer) haltHardTimer(hard_timer_enum_t timer) {
+
+	timer_ptr_t timerPtr = getTimer(timer);
+
+	// driver is torn down outside of interrupt context by releaseTimer
+	#if ESP_IDF_VERSION_MAJOR == 4
+		timer_group_set_counter_enable_in_isr((*timerPtr) -> group, (*timerPtr) -> num, TIMER_PAUSE);
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		gptimer_stop(**timerPtr);
+	#endif
+
+	HARD_TIMER_LOCK();
+	halted |= (1U << timer);
+	HARD_TIMER_UNLOCK();
+	HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
+}
+
+/**
+ * Stops timer and frees its driver
+ * 
+ * @param timer timer holding a driver
+ */
+void releaseTimer(hard_timer_enum_t timer) {
+
+	timer_ptr_t timerPtr = getTimer(timer);
+
+	#if ESP_IDF_VERSION_MAJOR == 4
+		// cancels timer
+		timer_set_alarm((*timerPtr) -> group, (*timerPtr) -> num, false);
+		timer_pause((*timerPtr) -> group, (*timerPtr) -> num);
+		timer_set_counter_value((*timerPtr) -> group, (*timerPtr) -> num, TIMER_COUNT_ZERO);
+
+		// deconstructs timer
+		timer_isr_callback_remove((*timerPtr) -> group, (*timerPtr) -> num);
+		timer_deinit((*timerPtr) -> group, (*timerPtr) -> num);
+
+		*timerPtr = NULL;
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		// halted timers were already stopped by haltHardTimer
+		if ((halted & (1U << timer)) == 0U) {
 			gptimer_stop(**timerPtr);
-			gptimer_disable(**timerPtr);
-			gptimer_del_timer(**timerPtr);
+		}
+		gptimer_disable(**timerPtr);
+		gptimer_del_timer(**timerPtr);
 
-			**timerPtr = NULL;
-			return true;
-		#endif
+		**timerPtr = NULL;
+	#endif
+
+	HARD_TIMER_LOCK();
+	halted &= ~(1U << timer);
+	HARD_TIMER_UNLOCK();
+}
+
+/**
+ * Frees driver of timer stopped by its callback
+ * 
+ * @param timer timer to free
+ */
+void releaseHaltedTimer(hard_timer_enum_t timer) {
+	if (timer != HARD_TIMER_INVALID && (halted & (1U << timer)) != 0U) {
+		releaseTimer(timer);
 	}
+}
 
+bool cancelHardTimer(hard_timer_enum_t timer) {
+	
+	if (hardTimerStarted(timer)) {
+		releaseTimer(timer);
+		HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
+		return true;
+	}
+
+	releaseHaltedTimer(timer);
 	return false;
 }
 
-bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+bool setHardTimerTyped(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type) {
 	
 	if (function == NULL || freq == NULL || timer == NULL) {
 		return false;
@@ -345,7 +443,8 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 
 		timer_ptr_t timerPtr = getTimer(*timer);
 
-		setHardTimerFunction(*timer, function, params);
+		releaseHaltedTimer(*timer);
+		setHardTimerFunctionTyped(*timer, function, params, type);
 		
 		#if ESP_IDF_VERSION_MAJOR == 4
 			// init timer
@@ -357,11 +456,14 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 				.auto_reload = false,
 			};
 			*timerPtr = &timerGroups[*timer];
+
+			// counter reloads on alarm
+			resetHardTimerInfo(*timer, TIMER_COUNT_ZERO, timerTicks, APB_CLK_FREQ / scalar);
 			
 			timer_init((*timerPtr) -> group, (*timerPtr) -> num, &config);
 			timer_set_counter_value((*timerPtr) -> group, (*timerPtr) -> num, TIMER_COUNT_ZERO);
 			timer_start((*timerPtr) -> group, (*timerPtr) -> num);
-			timer_isr_callback_add((*timerPtr) -> group, (*timerPtr) -> num, getHardTimerCallback(*timer), params, setPriority(priority));
+			timer_isr_callback_add((*timerPtr) -> group, (*timerPtr) -> num, getHardTimerCallback(*timer), params, setPriority(priority) | HARD_TIMER_INTR_FLAGS);
 
 			// run timer
 			timer_set_alarm_value((*timerPtr) -> group, (*timerPtr) -> num, timerTicks);
@@ -373,27 +475,18 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 
 		#elif ESP_IDF_VERSION_MAJOR == 5
 
-			uint64_t count = 1;
-			hard_timer_freq_t tempFreq = *freq;
-
-			// adjusts frequency to be above min
-			while (tempFreq < HARD_TIMER_FREQ_MIN) {
-				tempFreq *= 2;
-				count *= 2;
-			}
-
 			// timer config
 			gptimer_config_t config = {
 				.clk_src = GPTIMER_CLK_SRC_DEFAULT,
 				.direction = GPTIMER_COUNT_UP,
-				.resolution_hz = tempFreq,
+				.resolution_hz = APB_CLK_FREQ / scalar,
 				.intr_priority = setPriority(priority),
 			};
 
 			// function config
 			gptimer_alarm_config_t configAlarm = {
 				.reload_count = 0,
-				.alarm_count = count,
+				.alarm_count = timerTicks,
 				.flags.auto_reload_on_alarm = true,
 			};
 
@@ -402,6 +495,9 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 				.on_alarm = getHardTimerCallback(*timer),
 			};
 
+			// counter reloads on alarm
+			resetHardTimerInfo(*timer, configAlarm.reload_count, configAlarm.alarm_count, config.resolution_hz);
+
 			// creates new timer
 			gptimer_new_timer(&config, *timerPtr);
 
@@ -26,8 +26,17 @@
 #if HARDWARE_TIMER_SUPPORT_PICO
 
 #include <pico/time.h>
+#include <hardware/irq.h>
+#include <hardware/timer.h>
 
 #define THOUSAND 1000
+#define PRIORITY_POOLS 3 // alarm pools for ranges of timer priority
+
+#ifdef TIMER_ALARM_IRQ_NUM
+	#define ALARM_IRQ(alarm) TIMER_ALARM_IRQ_NUM(timer_hw, alarm) // interrupt of hardware alarm
+#else
+	#define ALARM_IRQ(alarm) (TIMER_IRQ_0 + (alarm)) // interrupt of hardware alarm
+#endif
 
 typedef enum {
 	SCALAR_MS, // timer prescalar for milli seconds
@@ -47,6 +56,42 @@ struct repeating_timer timers[HARD_TIMER_COUNT];
 storage_t timersStarted = 0U; // stores timer started state
 storage_t timersClaimed = 0U; // stores timer claimed state
 
+// NVIC priority of each alarm pool, lower values preempt higher ones
+static const uint8_t poolIrqPriorities[PRIORITY_POOLS] = {PICO_DEFAULT_IRQ_PRIORITY, 0x40, 0x00};
+
+// alarm pools of higher priorities, created when first used
+alarm_pool_t *priorityPools[PRIORITY_POOLS] = {NULL};
+
+/**
+ * Gets alarm pool running timers of priority
+ * 
+ * Lowest priorities share the default alarm pool, higher ones get a pool
+ * on a spare hardware alarm whose interrupt preempts the default pool
+ * 
+ * @param priority of type hard_timer_priority_t
+ * 
+ * @return alarm pool, default pool when no hardware alarm is free
+ */
+alarm_pool_t *getPriorityPool(hard_timer_priority_t priority) {
+
+	uint8_t level = priority * PRIORITY_POOLS / (UINT8_MAX + 1);
+
+	if (level == 0) {
+		return alarm_pool_get_default();
+	}
+	if (priorityPools[level] == NULL) {
+		int alarm = hardware_alarm_claim_unused(false);
+		if (alarm < 0) {
+			return alarm_pool_get_default();
+		}
+		// pool claims alarm again itself
+		hardware_alarm_unclaim(alarm);
+		priorityPools[level] = alarm_pool_create(alarm, HARD_TIMER_COUNT);
+		irq_set_priority(ALARM_IRQ(alarm), poolIrqPriorities[level]);
+	}
+	return priorityPools[level];
+}
+
 /**
  * Gets timer based on desired timer
  * 
@@ -67,17 +112,20 @@ struct repeating_timer* getTimer(hard_timer_enum_t timer) {
  * @param timer timer to set
  * @param state whether or not timer is started
  */
-void setTimerStarted(hard_timer_enum_t timer, bool state) {
+void HARD_TIMER_ISR_ATTR(setTimerStarted) setTimerStarted(hard_timer_enum_t timer, bool state) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return;
 	}
+	// ISRs clear started state of timers their callbacks stop
+	HARD_TIMER_LOCK();
 	if (state) {
 		timersStarted |= (((storage_t)1) << timer);
 	}
 	else {
 		timersStarted &= (~(((storage_t)1) << timer));
 	}
+	HARD_TIMER_UNLOCK();
 }
 
 /**
@@ -191,7 +239,7 @@ hard_timer_status_t getHardTimerStats(hard_timer_freq_t *freq, hard_timer_enum_t
 	return status;
 }
 
-bool hardTimerStarted(hard_timer_enum_t timer) {
+bool HARD_TIMER_ISR_ATTR(hardTimerStarted) hardTimerStarted(hard_timer_enum_t timer) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return false;
@@ -199,6 +247,27 @@ bool hardTimerStarted(hard_timer_enum_t timer) {
 	return !!((((storage_t)1) << timer) & timersStarted);
 }
 
+hard_timer_tick_t getHardTimerTicks(hard_timer_enum_t timer) {
+	// deadlines are absolute in us
+	return time_us_64();
+}
+
+void HARD_TIMER_ISR_ATTR(setHardTimerPeriod) setHardTimerPeriod(hard_timer_enum_t timer, hard_timer_tick_t period) {
+	// negative delay schedules from previous target
+	timers[timer].delay_us = -(int64_t)period;
+}
+
+hard_timer_tick_t HARD_TIMER_ISR_ATTR(getHardTimerPeriodMax) getHardTimerPeriodMax(hard_timer_enum_t timer) {
+	// delay is a signed 64 bit count of us
+	return (hard_timer_tick_t)INT64_MAX;
+}
+
+void HARD_TIMER_ISR_ATTR(haltHardTimer) haltHardTimer(hard_timer_enum_t timer) {
+	// callback returns false for stopped timers, so alarm pool drops them
+	setTimerStarted(timer, false);
+	HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
+}
+
 bool cancelHardTimer(hard_timer_enum_t timer) {
 
 	if (hardTimerStarted(timer)) {
@@ -207,13 +276,14 @@ bool cancelHardTimer(hard_timer_enum_t timer) {
 			return false;
 		}
 		setTimerStarted(timer, false);
+		HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_CANCEL, 0);
 		return true;
 	}
 
 	return false;
 }
 
-bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+bool setHardTimerTyped(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type) {
 
 	if (function == NULL || freq == NULL || timer == NULL) {
 		return false;
@@ -232,16 +302,23 @@ bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_
 	if (!hardTimerStarted(*timer)) {
 		struct repeating_timer* timerPtr = getTimer(*timer);
 
-		setHardTimerFunction(*timer, function, params);
+		setHardTimerFunctionTyped(*timer, function, params, type);
+
+		// deadlines are absolute in us, started before alarm is added
+		hard_timer_tick_t periodUS = (hard_timer_tick_t)timerTicks;
+		if (scalar == SCALAR_MS) {
+			periodUS *= THOUSAND;
+		}
+		resetHardTimerInfo(*timer, time_us_64(), periodUS, PICO_SDK_TIMER_MAX);
 
 		if (scalar == SCALAR_MS) {
-			if (add_repeating_timer_ms(-timerTicks, getHardTimerCallback(*timer), NULL, timerPtr)) {
+			if (alarm_pool_add_repeating_timer_ms(getPriorityPool(priority), -timerTicks, getHardTimerCallback(*timer), NULL, timerPtr)) {
 				setTimerStarted(*timer, true);
 				return true;
 			}
 		}
 		else if (scalar == SCALAR_US) {
-			if (add_repeating_timer_us(-timerTicks, getHardTimerCallback(*timer), NULL, timerPtr)) {
+			if (alarm_pool_add_repeating_timer_us(getPriorityPool(priority), -timerTicks, getHardTimerCallback(*timer), NULL, timerPtr)) {
 				setTimerStarted(*timer, true);
 				return true;
 			}
@@ -18,15 +18,77 @@
 
 #include "hardware_timer_priv.h"
 
+#if HARDWARE_TIMER_SUPPORT_AVR
+	#include <util/delay_basic.h>
+#elif HARDWARE_TIMER_SUPPORT_PICO
+	#include <pico/platform.h>
+	#include <pico/time.h>
+#endif
+
 #if !HARDWARE_TIMER_SUPPORT
 	#error "hardware_timer.h library not supported!"
 #endif
 
 // functions to execute at end of ISR
-hard_timer_function_ptr_t hardTimerFunctions[HARD_TIMER_COUNT];
+HARD_TIMER_ISR_DATA hard_timer_function_ptr_t hardTimerFunctions[HARD_TIMER_COUNT];
 
 // function parameters to pass
-void* hardTimerParams[HARD_TIMER_COUNT];
+HARD_TIMER_ISR_DATA void* hardTimerParams[HARD_TIMER_COUNT];
+
+// runtime state of timers
+HARD_TIMER_ISR_DATA hard_timer_info_t hardTimerInfo[HARD_TIMER_COUNT];
+
+// function called when timers overrun
+HARD_TIMER_ISR_DATA hard_timer_overrun_ptr_t hardTimerOverrunHook = NULL;
+
+#ifdef HARD_TIMER_LATENCY_STATS
+	// ISR latency histograms of timers
+	HARD_TIMER_ISR_DATA hard_timer_latency_t hardTimerLatency[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_PROFILE
+	// callback execution time profiles of timers
+	HARD_TIMER_ISR_DATA hard_timer_profile_t hardTimerProfile[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_DISCIPLINE
+	// reference clock discipline of timers
+	HARD_TIMER_ISR_DATA hard_timer_pll_t hardTimerPll[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_SLACK
+	// expiry coalescing of timers
+	HARD_TIMER_ISR_DATA hard_timer_coalesce_t hardTimerSlack[HARD_TIMER_COUNT];
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_AVR && defined(HARD_TIMER_AVR_COMPARE_B)
+	#define SLACK_COMPARE_B // compare B timers share period of compare A
+#endif
+
+#ifdef HARD_TIMER_TRACE
+	// ring buffer of trace records
+	HARD_TIMER_ISR_DATA hard_timer_trace_record_t hardTimerTrace[HARD_TIMER_TRACE_SIZE];
+
+	// unwrapped index of next trace record
+	HARD_TIMER_ISR_DATA unsigned int hardTimerTraceHead = 0U;
+
+	#if HARDWARE_TIMER_SUPPORT_PICO
+		// spin lock no other SDK user holds, shared by cores claiming records
+		spin_lock_t *hardTimerTraceLock = NULL;
+
+		/**
+		 * Claims trace spin lock before main runs, so timers always find it
+		 */
+		void __attribute__((constructor)) initHardTimerTrace() {
+			hardTimerTraceLock = spin_lock_instance((unsigned int)spin_lock_claim_unused(true));
+		}
+	#endif
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_ESP32
+	// lock for reading state shared with ISRs
+	portMUX_TYPE hardTimerMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 #ifndef NO_TIMER_CALLBACK_SUPPORT
 
@@ -36,19 +98,47 @@ void* hardTimerParams[HARD_TIMER_COUNT];
 	#if HARDWARE_TIMER_SUPPORT_ESP32
 
 		typedef bool hard_timer_callback_ret_t;
-		#define CALLBACK_RETURN() return false
+		// return value only asks for a context switch
+		#define CALLBACK_RETURN(num) return false
 
 		#if ESP_IDF_VERSION_MAJOR == 4
 			#define CALL_PARAMS void *params
+			// counter reloads at alarm, timer groups alternate between timers
+			#define CALLBACK_LATE(num) timer_group_get_counter_value_in_isr((num) % 2, (num) / 2)
+			// counter reloaded while callback ran
+			#define CALLBACK_OVERDUE(num, late) (CALLBACK_LATE(num) < (late))
 		#elif ESP_IDF_VERSION_MAJOR == 5
 			#define CALL_PARAMS gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *params
+			// counter reloads at alarm
+			#define CALLBACK_LATE(num) edata -> count_value
+			// counter reloaded while callback ran
+			#define CALLBACK_OVERDUE(num, late) gptimerReloaded(timer, late)
+
+			/**
+			 * Tests if timer counter reloaded since given count
+			 * 
+			 * @param timer timer handle
+			 * @param count count to compare against
+			 * 
+			 * @return if counter reloaded
+			 */
+			HARD_TIMER_INLINE bool gptimerReloaded(gptimer_handle_t timer, uint64_t count) {
+				uint64_t now = count;
+				gptimer_get_raw_count(timer, &now);
+				return now < count;
+			}
 		#endif
 
 	#elif HARDWARE_TIMER_SUPPORT_PICO
 
 		typedef bool hard_timer_callback_ret_t;
-		#define CALLBACK_RETURN() return true
+		// alarm pool drops timer stopped by its callback
+		#define CALLBACK_RETURN(num) return hardTimerStarted((hard_timer_enum_t)(num))
 		#define CALL_PARAMS repeating_timer_t *rt
+		// deadlines are absolute in us
+		#define CALLBACK_LATE(num) (time_us_64() - hardTimerInfo[num].deadline)
+		// next deadline passed while callback ran
+		#define CALLBACK_OVERDUE(num, late) (CALLBACK_LATE(num) >= hardTimerInfo[num].period)
 
 	#endif
 
@@ -58,9 +148,10 @@ void* hardTimerParams[HARD_TIMER_COUNT];
 	 * @param num timer number to set
 	 */
 	#define TIMER_CALLBACK_PROTOTYPE(num) \
-		static hard_timer_callback_ret_t HARD_TIMER_CONCATENATE(timerCallback, num)(CALL_PARAMS) { \
-			((void(*)())hardTimerFunctions[num])(hardTimerParams[num]); \
-			CALLBACK_RETURN(); \
+		static hard_timer_callback_ret_t HARD_TIMER_ISR_ATTR(HARD_TIMER_CONCATENATE(timerCallback, num)) \
+				HARD_TIMER_CONCATENATE(timerCallback, num)(CALL_PARAMS) { \
+			HARD_TIMER_DISPATCH(num, CALLBACK_LATE(num), CALLBACK_OVERDUE) \
+			CALLBACK_RETURN(num); \
 		}
 
 	#if HARD_TIMER_COUNT >= 1
@@ -124,12 +215,16 @@ void* hardTimerParams[HARD_TIMER_COUNT];
 		hardTimerCallbacks[num] = HARD_TIMER_CONCATENATE(timerCallback, num); \
 	break;
 
-bool setHardTimerFunction(hard_timer_enum_t timer, hard_timer_function_ptr_t function, void* params) {
+bool setHardTimerFunctionTyped(hard_timer_enum_t timer, hard_timer_function_ptr_t function, void* params, hard_timer_function_type_t type) {
 	if (timer == HARD_TIMER_INVALID) {
 		return false;
 	}
+	// ISRs of running timers never see a callback with another type
+	HARD_TIMER_LOCK();
 	hardTimerFunctions[timer] = function;
 	hardTimerParams[timer] = params;
+	hardTimerInfo[timer].functionType = type;
+	HARD_TIMER_UNLOCK();
 
 	#ifndef NO_TIMER_CALLBACK_SUPPORT
 
@@ -191,6 +286,870 @@ bool setHardTimerFunction(hard_timer_enum_t timer, hard_timer_function_ptr_t fun
 	return true;
 }
 
+bool setHardTimerFunction(hard_timer_enum_t timer, hard_timer_function_ptr_t function, void* params) {
+	return setHardTimerFunctionTyped(timer, function, params, HARD_TIMER_FUNCTION_VOID);
+}
+
+bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+	return setHardTimerTyped(timer, freq, function, params, priority, HARD_TIMER_FUNCTION_VOID);
+}
+
+bool setHardTimerEventFunction(hard_timer_enum_t timer, hard_timer_event_function_ptr_t function, void* params) {
+	return setHardTimerFunctionTyped(timer, (hard_timer_function_ptr_t)function, params, HARD_TIMER_FUNCTION_EVENT);
+}
+
+bool setHardTimerEvent(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_event_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+	return setHardTimerTyped(timer, freq, (hard_timer_function_ptr_t)function, params, priority, HARD_TIMER_FUNCTION_EVENT);
+}
+
+bool setHardTimerStoppableFunction(hard_timer_enum_t timer, hard_timer_stoppable_function_ptr_t function, void* params) {
+	return setHardTimerFunctionTyped(timer, (hard_timer_function_ptr_t)function, params, HARD_TIMER_FUNCTION_STOPPABLE);
+}
+
+bool setHardTimerStoppable(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_stoppable_function_ptr_t function, void* params, hard_timer_priority_t priority) {
+	return setHardTimerTyped(timer, freq, (hard_timer_function_ptr_t)function, params, priority, HARD_TIMER_FUNCTION_STOPPABLE);
+}
+
+#ifdef HARD_TIMER_SLACK
+
+/**
+ * Converts tolerance of timer to ticks
+ * 
+ * @param timer timer to convert tolerance of
+ * 
+ * @return ticks expiries may move, at most half a period
+ */
+hard_timer_tick_t getHardTimerSlackTicks(hard_timer_enum_t timer) {
+	hard_timer_info_t *info = &hardTimerInfo[timer];
+	uint64_t ticks = (uint64_t)hardTimerSlack[timer].state.toleranceUs * info -> tickFreq / 1000000UL;
+	if (ticks > info -> period / 2) {
+		ticks = info -> period / 2;
+	}
+	return (hard_timer_tick_t)ticks;
+}
+
+void HARD_TIMER_ISR_ATTR(coalesceHardTimer) coalesceHardTimer(uint8_t num) {
+	hard_timer_coalesce_t *slack = &hardTimerSlack[num];
+	hard_timer_info_t *info = &hardTimerInfo[num];
+
+	if (slack -> slackTicks == 0 && slack -> shift == 0 && slack -> offset == 0) {
+		if (slack -> trimmed) {
+			slack -> trimmed = false;
+			setHardTimerPeriod((hard_timer_enum_t)num, info -> period);
+		}
+		return;
+	}
+
+	int64_t best = 0;
+	bool shared = false;
+	hard_timer_tick_t remaining = info -> deadline - getHardTimerTicks((hard_timer_enum_t)num);
+	hard_timer_tick_t periodMax = getHardTimerPeriodMax((hard_timer_enum_t)num);
+
+	// moves keep expiries within slack of their schedule
+	int64_t earliest = -(int64_t)slack -> slackTicks - slack -> offset;
+	int64_t latest = (int64_t)slack -> slackTicks - slack -> offset;
+	if (latest > (int64_t)(periodMax - info -> period)) {
+		latest = (int64_t)(periodMax - info -> period);
+	}
+
+	// overdue timers catch up before they coalesce
+	bool search = slack -> slackTicks != 0 && remaining <= info -> period;
+	#ifdef SLACK_COMPARE_B
+		if (hardTimerStarted(HARD_TIMER_COMPARE_B(num))) {
+			search = false;
+		}
+	#endif
+
+	for (uint8_t i = 0; search && i < HARD_TIMER_COUNT; i++) {
+		hard_timer_info_t *other = &hardTimerInfo[i];
+		if (i == num || other -> tickFreq == 0 || !hardTimerStarted((hard_timer_enum_t)i)) {
+			continue;
+		}
+		hard_timer_tick_t otherRemaining = other -> deadline - getHardTimerTicks((hard_timer_enum_t)i);
+		#if !HARDWARE_TIMER_SUPPORT_PICO
+			// reloading counters count a moved period from its unmoved start
+			otherRemaining += (hard_timer_tick_t)hardTimerSlack[i].shift;
+		#endif
+		if (otherRemaining > 2 * other -> period) {
+			continue;
+		}
+
+		// expiries of other timer in ticks of this timer
+		uint64_t converted = ((uint64_t)otherRemaining * info -> tickFreq + other -> tickFreq / 2) / other -> tickFreq;
+		uint64_t otherPeriod = ((uint64_t)other -> period * info -> tickFreq + other -> tickFreq / 2) / other -> tickFreq;
+		if (converted < remaining && otherPeriod != 0) {
+			// last expiry of other timer before this one, or the one after if closer
+			converted += (remaining - converted) / otherPeriod * otherPeriod;
+			if (2 * (remaining - converted) > otherPeriod) {
+				converted += otherPeriod;
+			}
+		}
+		int64_t offset = (int64_t)converted - (int64_t)remaining;
+		if (offset < earliest || offset > latest) {
+			continue;
+		}
+		if (offset >= -1 && offset <= 1) {
+			// aligned within rounding of tick conversion
+			offset = 0;
+		}
+		if (!shared || (offset < 0 ? -offset : offset) < (best < 0 ? -best : best)) {
+			best = offset;
+		}
+		shared = true;
+	}
+
+	// unshared expiries go back to their schedule
+	int32_t shift = shared ? (int32_t)best : -slack -> offset;
+	if (shift > latest) {
+		shift = (int32_t)latest;
+	}
+
+	// hardware keeps moved period until it is changed again
+	if (shift != slack -> shift || slack -> trimmed) {
+		setHardTimerPeriod((hard_timer_enum_t)num, info -> period + shift);
+	}
+	slack -> trimmed = false;
+	info -> deadline += shift;
+	slack -> shift = shift;
+	slack -> offset += shift;
+	if (shift != 0) {
+		slack -> state.shifted++;
+	}
+	if (shared) {
+		slack -> state.shared++;
+	}
+}
+
+#endif
+
+void resetHardTimerInfo(hard_timer_enum_t timer, hard_timer_tick_t start, hard_timer_tick_t period, hard_timer_freq_t tickFreq) {
+	if (timer == HARD_TIMER_INVALID) {
+		return;
+	}
+	hardTimerInfo[timer].deadline = start + period;
+	hardTimerInfo[timer].period = period;
+	hardTimerInfo[timer].tickFreq = tickFreq;
+	hardTimerInfo[timer].sequence = 0;
+	hardTimerInfo[timer].overruns = 0;
+	hardTimerInfo[timer].missed = 0;
+	hardTimerInfo[timer].read = 0;
+	hardTimerInfo[timer].running = 0;
+	#ifdef HARD_TIMER_CLOCK_MISSED
+		hardTimerInfo[timer].clockScale = (uint32_t)(((uint64_t)HARD_TIMER_CLOCK_FREQ << HARD_TIMER_CLOCK_SHIFT) / tickFreq);
+	#endif
+	HARD_TIMER_TRACE_EVENT(timer, HARD_TIMER_TRACE_SET, 0);
+
+	#ifdef HARD_TIMER_LATENCY_STATS
+		memset(&hardTimerLatency[timer], 0, sizeof(hard_timer_latency_t));
+		#if HARDWARE_TIMER_SUPPORT_ESP32
+			uint64_t cycles = (uint64_t)HARD_TIMER_CYCLE_FREQ() * period;
+			hardTimerInfo[timer].cyclePeriod = (uint32_t)((cycles + tickFreq - 1) / tickFreq);
+			hardTimerLatency[timer].clockFreq = HARD_TIMER_CYCLE_FREQ();
+		#else
+			hardTimerLatency[timer].clockFreq = tickFreq;
+		#endif
+	#endif
+
+	#ifdef HARD_TIMER_DISCIPLINE
+		memset(&hardTimerPll[timer], 0, sizeof(hard_timer_pll_t));
+		hardTimerPll[timer].basePeriod = period;
+	#endif
+
+	#ifdef HARD_TIMER_PROFILE
+		memset(&hardTimerProfile[timer], 0, sizeof(hard_timer_profile_t));
+		#if HARDWARE_TIMER_SUPPORT_ESP32
+			hardTimerProfile[timer].clockFreq = HARD_TIMER_CYCLE_FREQ();
+		#elif HARDWARE_TIMER_SUPPORT_PICO && defined(HARD_TIMER_PICO_SYSTICK)
+			// SysTick of setting core free runs on core clocks, without its interrupt
+			systick_hw -> rvr = HARD_TIMER_SYSTICK_MASK;
+			systick_hw -> csr = 0x5U; // CLKSOURCE and ENABLE, same bits on RP2040 and RP2350
+			hardTimerProfile[timer].clockFreq = HARD_TIMER_CPU_FREQ();
+		#else
+			hardTimerProfile[timer].clockFreq = tickFreq;
+		#endif
+	#endif
+
+	#ifdef HARD_TIMER_SLACK
+		// tolerance is kept across sets
+		uint32_t toleranceUs = hardTimerSlack[timer].state.toleranceUs;
+		memset(&hardTimerSlack[timer], 0, sizeof(hard_timer_coalesce_t));
+		hardTimerSlack[timer].state.toleranceUs = toleranceUs;
+		hardTimerSlack[timer].slackTicks = getHardTimerSlackTicks(timer);
+	#endif
+}
+
+bool getHardTimerOverruns(hard_timer_enum_t timer, hard_timer_overrun_t *overruns) {
+	if (timer == HARD_TIMER_INVALID || overruns == NULL) {
+		return false;
+	}
+	HARD_TIMER_LOCK();
+	overruns -> expiries = hardTimerInfo[timer].sequence;
+	overruns -> overruns = hardTimerInfo[timer].overruns;
+	overruns -> missed = hardTimerInfo[timer].missed;
+	HARD_TIMER_UNLOCK();
+	return true;
+}
+
+/**
+ * Callback of polled timers, expiries are only counted
+ * 
+ * @param params unused
+ */
+void HARD_TIMER_RAM_ATTR(pollHardTimerFunction) pollHardTimerFunction(void *params) {
+	(void)params;
+}
+
+bool setHardTimerPolled(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_priority_t priority) {
+	return setHardTimer(timer, freq, &pollHardTimerFunction, NULL, priority);
+}
+
+uint32_t readHardTimer(hard_timer_enum_t timer) {
+	if (timer < 0 || timer >= HARD_TIMER_COUNT) {
+		return 0;
+	}
+	HARD_TIMER_LOCK();
+	// missed periods never got their own expiry, so are counted with them
+	uint32_t expiries = hardTimerInfo[timer].sequence + hardTimerInfo[timer].missed;
+	uint32_t count = expiries - hardTimerInfo[timer].read;
+	hardTimerInfo[timer].read = expiries;
+	HARD_TIMER_UNLOCK();
+	return count;
+}
+
+uint32_t getHardTimerReady() {
+	uint32_t ready = 0U;
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (!hardTimerStarted((hard_timer_enum_t)i)) {
+			continue;
+		}
+		hard_timer_info_t *info = &hardTimerInfo[i];
+		HARD_TIMER_LOCK();
+		if (info -> sequence + info -> missed != info -> read) {
+			ready |= 1UL << i;
+		}
+		HARD_TIMER_UNLOCK();
+	}
+	return ready;
+}
+
+bool getHardTimerLatency(hard_timer_enum_t timer, hard_timer_latency_t *latency) {
+	#ifdef HARD_TIMER_LATENCY_STATS
+		if (timer == HARD_TIMER_INVALID || latency == NULL) {
+			return false;
+		}
+		HARD_TIMER_LOCK();
+		*latency = hardTimerLatency[timer];
+		HARD_TIMER_UNLOCK();
+
+		latency -> mean = 0;
+		if (latency -> count != 0) {
+			latency -> mean = (uint32_t)(latency -> total / latency -> count);
+		}
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+bool getHardTimerProfile(hard_timer_enum_t timer, hard_timer_profile_t *profile) {
+	#ifdef HARD_TIMER_PROFILE
+		if (timer == HARD_TIMER_INVALID || profile == NULL) {
+			return false;
+		}
+		HARD_TIMER_LOCK();
+		*profile = hardTimerProfile[timer];
+		HARD_TIMER_UNLOCK();
+
+		profile -> average >>= HARD_TIMER_PROFILE_EMA_SHIFT;
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+uint8_t getHardTimerLoad(hard_timer_enum_t timer) {
+	#ifdef HARD_TIMER_PROFILE
+		hard_timer_profile_t profile;
+		if (!getHardTimerProfile(timer, &profile)) {
+			return 0;
+		}
+
+		HARD_TIMER_LOCK();
+		hard_timer_tick_t period = hardTimerInfo[timer].period;
+		hard_timer_freq_t tickFreq = hardTimerInfo[timer].tickFreq;
+		HARD_TIMER_UNLOCK();
+
+		if (period == 0 || profile.clockFreq == 0) {
+			return 0;
+		}
+
+		// average callback time over period, both in seconds
+		uint64_t load = ((uint64_t)profile.average * tickFreq * 100U) / ((uint64_t)profile.clockFreq * period);
+		if (load > 100U) {
+			return 100U;
+		}
+		return (uint8_t)load;
+	#else
+		return 0;
+	#endif
+}
+
+#ifdef HARD_TIMER_DISCIPLINE
+
+/**
+ * Clamps value to range of discipline trims
+ * 
+ * @param ppb parts per billion to clamp
+ * 
+ * @return clamped parts per billion
+ */
+static int32_t clampHardTimerPpb(int64_t ppb) {
+	if (ppb > HARD_TIMER_DISCIPLINE_LIMIT_PPB) {
+		return HARD_TIMER_DISCIPLINE_LIMIT_PPB;
+	}
+	if (ppb < -HARD_TIMER_DISCIPLINE_LIMIT_PPB) {
+		return -HARD_TIMER_DISCIPLINE_LIMIT_PPB;
+	}
+	return (int32_t)ppb;
+}
+
+#endif
+
+bool disciplineHardTimer(hard_timer_enum_t timer, uint64_t referenceUs) {
+	#ifdef HARD_TIMER_DISCIPLINE
+		if (timer == HARD_TIMER_INVALID || !hardTimerStarted(timer)) {
+			return false;
+		}
+		hard_timer_pll_t *pll = &hardTimerPll[timer];
+
+		HARD_TIMER_LOCK();
+		hard_timer_tick_t ticks = getHardTimerTicks(timer);
+		hard_timer_info_t info = hardTimerInfo[timer];
+		HARD_TIMER_UNLOCK();
+
+		if (info.period == 0 || info.tickFreq == 0) {
+			return false;
+		}
+
+		// nominal microseconds of expiries counted, in fixed point
+		int64_t periodUs = (int64_t)(((uint64_t)pll -> basePeriod * 1000000ULL * HARD_TIMER_TRIM_ONE) / info.tickFreq);
+		int64_t fraction = (int64_t)(((int64_t)(ticks - (info.deadline - info.period)) * HARD_TIMER_TRIM_ONE) / (int64_t)info.period);
+		int64_t elapsed = (int64_t)info.sequence * periodUs + fraction * periodUs / HARD_TIMER_TRIM_ONE;
+
+		if (pll -> state.references == 0) {
+			pll -> refStart = referenceUs;
+			pll -> elapsedStart = elapsed;
+		}
+		else {
+			// frequency error of timer clock since last reference
+			int64_t expected = (int64_t)((referenceUs - pll -> refLast) * info.tickFreq / 1000000ULL);
+			if (expected <= 0) {
+				return false;
+			}
+			int64_t measured = (int64_t)(ticks - pll -> ticksLast);
+			int32_t offset = clampHardTimerPpb((measured - expected) * 1000000000LL / expected);
+			if (pll -> state.references == 1) {
+				pll -> state.offsetPpb = offset;
+			}
+			else {
+				pll -> state.offsetPpb += (offset - pll -> state.offsetPpb) / (1 << HARD_TIMER_DISCIPLINE_SHIFT);
+			}
+
+			// phase error removed over HARD_TIMER_DISCIPLINE_TAU seconds
+			int64_t phase = (elapsed - pll -> elapsedStart) / HARD_TIMER_TRIM_ONE - (int64_t)(referenceUs - pll -> refStart);
+			pll -> state.phaseUs = (int32_t)phase;
+			pll -> state.trimPpb = clampHardTimerPpb(pll -> state.offsetPpb + phase * 1000 / HARD_TIMER_DISCIPLINE_TAU);
+
+			int32_t trim = (int32_t)((int64_t)pll -> basePeriod * pll -> state.trimPpb * HARD_TIMER_TRIM_ONE / 1000000000LL);
+			HARD_TIMER_LOCK();
+			pll -> trim = trim;
+			HARD_TIMER_UNLOCK();
+		}
+
+		pll -> refLast = referenceUs;
+		pll -> ticksLast = ticks;
+		pll -> state.references++;
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+bool getHardTimerDiscipline(hard_timer_enum_t timer, hard_timer_discipline_t *discipline) {
+	#ifdef HARD_TIMER_DISCIPLINE
+		if (timer == HARD_TIMER_INVALID || discipline == NULL) {
+			return false;
+		}
+		HARD_TIMER_LOCK();
+		*discipline = hardTimerPll[timer].state;
+		HARD_TIMER_UNLOCK();
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+bool setHardTimerTolerance(hard_timer_enum_t timer, uint32_t toleranceUs) {
+	#ifdef HARD_TIMER_SLACK
+		if (timer == HARD_TIMER_INVALID) {
+			return false;
+		}
+		#ifdef SLACK_COMPARE_B
+			if (timer >= HARD_TIMER_HARDWARE_COUNT) {
+				return false;
+			}
+		#endif
+		HARD_TIMER_LOCK();
+		hardTimerSlack[timer].state.toleranceUs = toleranceUs;
+		hardTimerSlack[timer].slackTicks = getHardTimerSlackTicks(timer);
+		HARD_TIMER_UNLOCK();
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+bool getHardTimerSlack(hard_timer_enum_t timer, hard_timer_slack_t *slack) {
+	#ifdef HARD_TIMER_SLACK
+		if (timer == HARD_TIMER_INVALID || slack == NULL) {
+			return false;
+		}
+		HARD_TIMER_LOCK();
+		*slack = hardTimerSlack[timer].state;
+		uint32_t expiries = hardTimerInfo[timer].sequence;
+		hard_timer_tick_t period = hardTimerInfo[timer].period;
+		hard_timer_freq_t tickFreq = hardTimerInfo[timer].tickFreq;
+		HARD_TIMER_UNLOCK();
+
+		// shared fraction of expiries times expiries per thousand seconds
+		slack -> savedMilliHz = 0;
+		if (expiries != 0 && period != 0) {
+			uint64_t milliHz = (uint64_t)tickFreq * 1000U / period;
+			slack -> savedMilliHz = (uint32_t)(slack -> shared * milliHz / expiries);
+		}
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+uint16_t getHardTimerTrace(hard_timer_trace_record_t *records, uint16_t maxRecords, hard_timer_freq_t *clockFreq) {
+	#ifdef HARD_TIMER_TRACE
+		if (clockFreq != NULL) {
+			*clockFreq = HARD_TIMER_CLOCK_FREQ;
+		}
+		if (records == NULL) {
+			return 0;
+		}
+
+		// skips oldest records that don't fit
+		unsigned int head = hardTimerTraceHead;
+		uint16_t used = 0;
+		for (uint16_t i = 0; i < HARD_TIMER_TRACE_SIZE; i++) {
+			if (hardTimerTrace[i].event != HARD_TIMER_TRACE_NONE) {
+				used++;
+			}
+		}
+		uint16_t skip = used > maxRecords ? used - maxRecords : 0;
+
+		uint16_t count = 0;
+		for (uint16_t i = 0; i < HARD_TIMER_TRACE_SIZE && count < maxRecords; i++) {
+			hard_timer_trace_record_t *stored = &hardTimerTrace[(head + i) & (HARD_TIMER_TRACE_SIZE - 1)];
+			HARD_TIMER_LOCK();
+			hard_timer_trace_record_t record = *stored;
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			// ISRs on the other core may rewrite record while it is copied
+			bool torn = __atomic_load_n(&stored -> event, __ATOMIC_ACQUIRE) != record.event || stored -> timestamp != record.timestamp;
+			HARD_TIMER_UNLOCK();
+
+			if (record.event == HARD_TIMER_TRACE_NONE || torn) {
+				continue;
+			}
+			if (skip != 0) {
+				skip--;
+				continue;
+			}
+			records[count++] = record;
+		}
+		return count;
+	#else
+		return 0;
+	#endif
+}
+
+void clearHardTimerTrace() {
+	#ifdef HARD_TIMER_TRACE
+		HARD_TIMER_LOCK();
+		memset(hardTimerTrace, 0, sizeof(hardTimerTrace));
+		HARD_TIMER_UNLOCK();
+	#endif
+}
+
+/**
+ * Waits until replay reaches time of record
+ * 
+ * @param start hardTimerNow when replay started
+ * @param elapsed trace clock cycles since first record
+ * @param clockFreq trace clock cycles per second
+ * @param speedup times faster than recorded to replay
+ */
+void waitHardTimerReplay(uint64_t start, uint64_t elapsed, hard_timer_freq_t clockFreq, uint16_t speedup) {
+	uint64_t divider = (uint64_t)clockFreq * speedup;
+	// splits conversion so long traces don't overflow
+	uint64_t ticks = elapsed / divider * HARD_TIMER_NOW_FREQ;
+	ticks += elapsed % divider * HARD_TIMER_NOW_FREQ / divider;
+	while (hardTimerNow() - start < ticks);
+}
+
+/**
+ * Gets missed periods of a fire record from the overrun recorded after it
+ * 
+ * @param records trace records
+ * @param count number of records
+ * @param index index of fire record
+ * 
+ * @return whole periods fire was late by
+ */
+uint32_t getHardTimerReplayMissed(const hard_timer_trace_record_t *records, uint16_t count, uint16_t index) {
+	// overruns are recorded after the callback of the fire they belong to
+	for (uint16_t i = index + 1; i < count; i++) {
+		if (records[i].timer != records[index].timer) {
+			continue;
+		}
+		if (records[i].event == HARD_TIMER_TRACE_OVERRUN) {
+			return records[i].data;
+		}
+		if (records[i].event == HARD_TIMER_TRACE_FIRE) {
+			break;
+		}
+	}
+	return 0U;
+}
+
+/**
+ * Converts trace clock cycles to ticks of a timer
+ * 
+ * @param elapsed trace clock cycles since first record
+ * @param tickFreq timer ticks per second
+ * @param clockFreq trace clock cycles per second
+ * 
+ * @return timer ticks since first record
+ */
+hard_timer_tick_t getHardTimerReplayTicks(uint64_t elapsed, hard_timer_freq_t tickFreq, hard_timer_freq_t clockFreq) {
+	// splits conversion so long traces don't overflow
+	uint64_t ticks = elapsed / clockFreq * tickFreq;
+	ticks += elapsed % clockFreq * tickFreq / clockFreq;
+	return (hard_timer_tick_t)ticks;
+}
+
+// replayed schedule of a timer
+typedef struct {
+	uint32_t sequence; // recorded sequence extended past 16 bits
+	hard_timer_tick_t start; // ticks sequence 0 was due at
+	bool fired; // whether a fire was replayed
+} hard_timer_replay_t;
+
+uint16_t replayHardTimerTrace(const hard_timer_trace_record_t *records, uint16_t count, hard_timer_freq_t clockFreq, uint16_t speedup) {
+	if (records == NULL || count == 0) {
+		return 0;
+	}
+
+	// replays as fast as possible without a clock to pace with
+	bool paced = speedup != 0 && clockFreq != 0 && HARD_TIMER_NOW_FREQ != 0;
+	hard_timer_replay_t replay[HARD_TIMER_COUNT] = {0};
+	uint64_t elapsed = 0U;
+	uint64_t start = hardTimerNow();
+	uint16_t run = 0;
+
+	for (uint16_t i = 0; i < count; i++) {
+		const hard_timer_trace_record_t *record = &records[i];
+		if (i != 0) {
+			// 32 bit timestamps wrap between records
+			elapsed += (uint32_t)(record -> timestamp - records[i - 1].timestamp);
+		}
+		if (record -> timer < 0 || record -> timer >= HARD_TIMER_COUNT) {
+			continue;
+		}
+		uint8_t num = (uint8_t)record -> timer;
+		if (record -> event != HARD_TIMER_TRACE_FIRE || hardTimerFunctions[num] == NULL) {
+			continue;
+		}
+
+		// 16 bit recorded sequence wraps between fires
+		hard_timer_replay_t *state = &replay[num];
+		if (state -> fired) {
+			state -> sequence += (uint16_t)(record -> data - (uint16_t)state -> sequence);
+		}
+		else {
+			state -> sequence = record -> data;
+		}
+
+		if (paced) {
+			waitHardTimerReplay(start, elapsed, clockFreq, speedup);
+		}
+
+		// callbacks run outside the lock, long ones would stall interrupts and spin locks
+		if (hardTimerInfo[num].functionType == HARD_TIMER_FUNCTION_EVENT) {
+			hard_timer_info_t *info = &hardTimerInfo[num];
+			uint32_t missed = getHardTimerReplayMissed(records, count, i);
+			hard_timer_tick_t timestamp = info -> period * (state -> sequence + missed);
+			if (clockFreq != 0) {
+				// ticks of the trace clock when the timer was never set
+				timestamp = getHardTimerReplayTicks(elapsed, info -> tickFreq != 0 ? info -> tickFreq : clockFreq, clockFreq);
+			}
+
+			// schedule starts at the earliest fire, so lateness is relative to it
+			hard_timer_tick_t deadline = state -> start + info -> period * state -> sequence;
+			if (!state -> fired || timestamp - deadline > (hard_timer_tick_t)-1 / 2) {
+				state -> start = timestamp - info -> period * state -> sequence;
+				deadline = timestamp;
+			}
+
+			hard_timer_event_t event = {
+				.timestamp = timestamp,
+				.deadline = deadline,
+				.period = info -> period,
+				.sequence = state -> sequence,
+				.missed = missed,
+			};
+			((hard_timer_event_function_ptr_t)hardTimerFunctions[num])(&event, hardTimerParams[num]);
+		}
+		else if (hardTimerInfo[num].functionType == HARD_TIMER_FUNCTION_STOPPABLE) {
+			// replayed callbacks can't stop timers
+			((hard_timer_stoppable_function_ptr_t)hardTimerFunctions[num])(hardTimerParams[num]);
+		}
+		else {
+			((void(*)())hardTimerFunctions[num])(hardTimerParams[num]);
+		}
+		state -> fired = true;
+		run++;
+	}
+	return run;
+}
+
+/**
+ * Takes cost of delay call off wait
+ * 
+ * @param ticks CPU cycles to wait for
+ * 
+ * @return CPU cycles left to wait for
+ */
+HARD_TIMER_INLINE uint32_t trimHardTimerDelay(uint32_t ticks) {
+	return ticks > HARD_TIMER_DELAY_OVERHEAD ? ticks - HARD_TIMER_DELAY_OVERHEAD : 0;
+}
+
+#if HARD_TIMER_CLOCK_FREQ != 0
+
+/**
+ * Takes cost of delay call off wait on free running clock
+ * 
+ * @param clocks clock cycles to wait for
+ * 
+ * @return clock cycles left to wait for
+ */
+HARD_TIMER_INLINE uint32_t trimHardTimerDelayClock(uint32_t clocks) {
+	uint32_t overhead = (uint32_t)((uint64_t)HARD_TIMER_DELAY_OVERHEAD * HARD_TIMER_CLOCK_FREQ / HARD_TIMER_CPU_FREQ());
+	return clocks > overhead ? clocks - overhead : 0;
+}
+
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_ESP32
+
+/**
+ * Waits until CPU cycle counter is ticks past start
+ * 
+ * @param start CPU cycle counter when wait started
+ * @param ticks CPU cycles to wait for
+ */
+HARD_TIMER_INLINE void spinHardTimerCycles(uint32_t start, uint32_t ticks) {
+	while ((uint32_t)(HARD_TIMER_CYCLES() - start) < ticks) {
+		__asm__ __volatile__ ("nop");
+	}
+}
+
+#else
+
+/**
+ * Runs cycle counted loop
+ * 
+ * @param ticks CPU cycles to wait for
+ */
+HARD_TIMER_INLINE void spinHardTimerCycles(uint32_t ticks) {
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		// loop counts take 4 cycles each and a count of 0 runs 65536 times
+		uint32_t loops = ticks >> 2;
+		while (loops > UINT16_MAX) {
+			_delay_loop_2(0);
+			loops -= (uint32_t)UINT16_MAX + 1;
+		}
+		if (loops != 0) {
+			_delay_loop_2((uint16_t)loops);
+		}
+	#elif HARDWARE_TIMER_SUPPORT_PICO
+		busy_wait_at_least_cycles(ticks);
+	#endif
+}
+
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_AVR && HARD_TIMER_CLOCK_FREQ != 0
+
+#define DELAY_CLOCK_CYCLES (F_CPU / HARD_TIMER_CLOCK_FREQ) // CPU cycles per Arduino timer 0 tick
+#define DELAY_CLOCK_MIN 8 // fewest Arduino timer 0 ticks worth waiting on it for
+
+/**
+ * Waits on Arduino timer 0, so interrupts don't lengthen long waits,
+ * and runs cycle counted loop for short ones
+ * 
+ * A wait starts anywhere within a clock tick, so it waits one tick past
+ * the whole ticks asked for and ends within a tick of the cycles asked for
+ * 
+ * @param ticks CPU cycles to wait for, with cost of call taken off
+ */
+void spinHardTimerDelay(uint32_t ticks) {
+	if (ticks < DELAY_CLOCK_MIN * DELAY_CLOCK_CYCLES) {
+		spinHardTimerCycles(ticks);
+		return;
+	}
+	uint32_t clocks = ticks / DELAY_CLOCK_CYCLES + 1;
+	uint32_t start = HARD_TIMER_CLOCK();
+	while ((uint32_t)(HARD_TIMER_CLOCK() - start) < clocks);
+}
+
+#endif
+
+void HARD_TIMER_RAM_ATTR(hardTimerDelayTicks) hardTimerDelayTicks(uint32_t ticks) {
+	#if HARDWARE_TIMER_SUPPORT_ESP32
+		uint32_t start = HARD_TIMER_CYCLES();
+		spinHardTimerCycles(start, trimHardTimerDelay(ticks));
+	#elif HARDWARE_TIMER_SUPPORT_AVR && HARD_TIMER_CLOCK_FREQ != 0
+		spinHardTimerDelay(trimHardTimerDelay(ticks));
+	#else
+		spinHardTimerCycles(trimHardTimerDelay(ticks));
+	#endif
+}
+
+void HARD_TIMER_RAM_ATTR(hardTimerDelayUs) hardTimerDelayUs(uint32_t us) {
+	#if HARDWARE_TIMER_SUPPORT_ESP32
+		// esp_timer counts microseconds, so CPU frequency changes and wraps don't shorten waits
+		int64_t start = esp_timer_get_time();
+		int64_t wait = (int64_t)trimHardTimerDelayClock(us);
+		while (esp_timer_get_time() - start < wait) {
+			__asm__ __volatile__ ("nop");
+		}
+	#elif HARDWARE_TIMER_SUPPORT_PICO
+		// timer counts microseconds, so interrupts don't lengthen waits
+		busy_wait_us_32(trimHardTimerDelayClock(us));
+	#elif HARD_TIMER_CLOCK_FREQ != 0
+		spinHardTimerDelay(trimHardTimerDelay(us * (F_CPU / 1000000UL)));
+	#else
+		spinHardTimerCycles(trimHardTimerDelay(us * (F_CPU / 1000000UL)));
+	#endif
+}
+
+#if HARDWARE_TIMER_SUPPORT_AVR && HARD_TIMER_NOW_FREQ != 0
+	// wraps of Arduino timer 0 overflow count seen by hardTimerNow
+	static volatile uint8_t nowWraps = 0U;
+
+	// top two bits of Arduino timer 0 overflow count when nowWraps was updated
+	static volatile uint8_t nowQuarter = 0U;
+
+	// bumped on every update so readers can retry instead of locking
+	static volatile uint8_t nowSequence = 0U;
+
+	/**
+	 * Gets wraps of timer 0 overflow count for an overflow count read.
+	 * 
+	 * @param quarter top two bits of overflow count read
+	 * @param seen quarter when wraps was updated
+	 * @param wraps wraps when seen was updated
+	 * @return wraps for overflow count read
+	 */
+	static inline uint8_t getHardTimerNowWraps(uint8_t quarter, uint8_t seen, uint8_t wraps) {
+		if (quarter == 3U && seen == 0U) {
+			// read just before a wrap another caller already saw
+			wraps--;
+		}
+		return wraps;
+	}
+#endif
+
+uint64_t HARD_TIMER_RAM_ATTR(hardTimerNow) hardTimerNow() {
+	#if HARDWARE_TIMER_SUPPORT_ESP32
+		return (uint64_t)esp_timer_get_time();
+	#elif HARDWARE_TIMER_SUPPORT_PICO
+		return time_us_64();
+	#elif HARD_TIMER_NOW_FREQ != 0
+		uint32_t overflows;
+		uint8_t count;
+		bool pending;
+
+		// rereads when the overflow interrupt lands between reads instead of locking
+		do {
+			overflows = timer0_overflow_count;
+			count = TCNT0;
+			pending = TIFR0 & (1 << TOV0);
+		} while (overflows != timer0_overflow_count);
+
+		if (pending && count < UINT8_MAX) {
+			// overflow not yet counted while interrupts are disabled
+			overflows++;
+		}
+
+		// extends overflow count past 32 bits by watching its top two bits,
+		// which move at most two quarters ahead between reads at least every 24 days
+		// and one quarter behind when another caller updated after this read
+		uint8_t quarter = (uint8_t)(overflows >> 30);
+		uint8_t sequence;
+		uint8_t wraps;
+		uint8_t seen;
+		do {
+			sequence = nowSequence;
+			wraps = nowWraps;
+			seen = nowQuarter;
+		} while (sequence != nowSequence);
+
+		uint8_t ahead = (uint8_t)(quarter - seen) & 3U;
+		if (ahead == 0U || ahead == 3U) {
+			wraps = getHardTimerNowWraps(quarter, seen, wraps);
+		}
+		else {
+			// only once a quarter, rechecking since another caller may have updated first
+			HARD_TIMER_LOCK();
+			seen = nowQuarter;
+			ahead = (uint8_t)(quarter - seen) & 3U;
+			if (ahead == 1U || ahead == 2U) {
+				if (quarter < seen) {
+					nowWraps++;
+				}
+				nowQuarter = quarter;
+				nowSequence++;
+				seen = quarter;
+			}
+			wraps = getHardTimerNowWraps(quarter, seen, nowWraps);
+			HARD_TIMER_UNLOCK();
+		}
+		return ((uint64_t)wraps << 40) | ((uint64_t)overflows << 8) | count;
+	#else
+		return 0;
+	#endif
+}
+
+uint64_t hardTimerToNs(uint64_t ticks) {
+	#if HARD_TIMER_NOW_FREQ == 0
+		return 0;
+	#elif 1000000000UL % HARD_TIMER_NOW_FREQ == 0
+		return ticks * (1000000000UL / HARD_TIMER_NOW_FREQ);
+	#else
+		return ticks / HARD_TIMER_NOW_FREQ * 1000000000ULL + ticks % HARD_TIMER_NOW_FREQ * 1000000000ULL / HARD_TIMER_NOW_FREQ;
+	#endif
+}
+
+void setHardTimerOverrunHook(hard_timer_overrun_ptr_t hook) {
+	hardTimerOverrunHook = hook;
+}
+
 hard_timer_callback_ptr_t getHardTimerCallback(hard_timer_enum_t timer) {
 	#ifndef NO_TIMER_CALLBACK_SUPPORT
 		if (timer == HARD_TIMER_INVALID) {
@@ -54,13 +54,760 @@
  */
 #define HARD_TIMER_CONCATENATE3(a, b, c) a ## b ## c
 
+/**
+ * IRAM mode, enabled by defining HARD_TIMER_IRAM_SAFE
+ * 
+ * Places the ISR callbacks and the tables they read in RAM
+ * so timers keep firing while flash cache is disabled
+ */
+#ifdef HARD_TIMER_IRAM_SAFE
+	#define HARD_TIMER_ISR_ATTR(funcName) HARD_TIMER_RAM_ATTR(funcName) // placement for ISR functions
+	#define HARD_TIMER_ISR_DATA HARD_TIMER_DATA_ATTR // placement for ISR variables
+#else
+	#define HARD_TIMER_ISR_ATTR(funcName) // placement for ISR functions
+	#define HARD_TIMER_ISR_DATA // placement for ISR variables
+#endif
+
 #if HARDWARE_TIMER_SUPPORT_AVR
 	#define HARDWARE_TIMER_NO_CALLBACK_SUPPORT // hardware timer doesn't use callbacks
 #endif
 
-#ifdef HARDWARE_TIMER_NO_CALLBACK_SUPPORT
-	extern hard_timer_function_ptr_t hardTimerFunctions[HARD_TIMER_COUNT];
-	extern void* hardTimerParams[HARD_TIMER_COUNT];
+#define HARD_TIMER_INLINE static inline __attribute__((always_inline)) // inlines function into ISR
+
+/**
+ * Critical sections for reading state shared with ISRs
+ * 
+ * @note HARD_TIMER_LOCK() and HARD_TIMER_UNLOCK() must be used in the same scope
+ */
+#if HARDWARE_TIMER_SUPPORT_AVR
+	#include <avr/io.h>
+	#include <avr/interrupt.h>
+	#define HARD_TIMER_LOCK() uint8_t hardTimerLockState = SREG; cli()
+	#define HARD_TIMER_UNLOCK() SREG = hardTimerLockState
+#elif HARDWARE_TIMER_SUPPORT_ESP32
+	#include <freertos/FreeRTOS.h>
+	extern portMUX_TYPE hardTimerMux;
+	#define HARD_TIMER_LOCK() portENTER_CRITICAL_SAFE(&hardTimerMux)
+	#define HARD_TIMER_UNLOCK() portEXIT_CRITICAL_SAFE(&hardTimerMux)
+#elif HARDWARE_TIMER_SUPPORT_PICO
+	#include <hardware/sync.h>
+	#define HARD_TIMER_LOCK() uint32_t hardTimerLockState = save_and_disable_interrupts()
+	#define HARD_TIMER_UNLOCK() restore_interrupts(hardTimerLockState)
+#else
+	#define HARD_TIMER_LOCK()
+	#define HARD_TIMER_UNLOCK()
+#endif
+
+/**
+ * Free running CPU cycle counter
+ */
+#if HARDWARE_TIMER_SUPPORT_ESP32
+	#if ESP_IDF_VERSION_MAJOR == 4
+		#include <hal/cpu_hal.h>
+		#define HARD_TIMER_CYCLES() cpu_hal_get_cycle_count() // reads CCOUNT
+	#elif ESP_IDF_VERSION_MAJOR == 5
+		#include <esp_cpu.h>
+		#define HARD_TIMER_CYCLES() esp_cpu_get_cycle_count() // reads CCOUNT
+	#endif
+	#include <esp_rom_sys.h>
+	#define HARD_TIMER_CYCLE_FREQ() (esp_rom_get_cpu_ticks_per_us() * 1000000UL) // CPU cycles per second
+#endif
+
+/**
+ * Free running clock read into 32 bit timestamps
+ */
+#if HARDWARE_TIMER_SUPPORT_ESP32
+	#include <esp_timer.h>
+	#define HARD_TIMER_CPU_FREQ() HARD_TIMER_CYCLE_FREQ() // CPU cycles per second
+	#define HARD_TIMER_CLOCK() ((uint32_t)esp_timer_get_time()) // microseconds
+	#define HARD_TIMER_CLOCK_FREQ 1000000UL // clock cycles per second
+#elif HARDWARE_TIMER_SUPPORT_PICO
+	#include <hardware/clocks.h>
+	#define HARD_TIMER_CPU_FREQ() clock_get_hz(clk_sys) // CPU cycles per second
+	#define HARD_TIMER_CLOCK() time_us_32() // microseconds
+	#define HARD_TIMER_CLOCK_FREQ 1000000UL // clock cycles per second
+#elif HARDWARE_TIMER_SUPPORT_AVR && defined(ARDUINO) && !defined(OVERRIDE_ARDUINO_TIMER)
+	#define HARD_TIMER_CPU_FREQ() F_CPU // CPU cycles per second
+	extern volatile unsigned long timer0_overflow_count; // overflows of Arduino timer 0
+
+	/**
+	 * Reads Arduino timer 0 including pending overflow
+	 * 
+	 * @return Arduino timer 0 ticks
+	 */
+	HARD_TIMER_INLINE uint32_t readArduinoClock() {
+		HARD_TIMER_LOCK();
+		uint32_t overflows = timer0_overflow_count;
+		uint8_t count = TCNT0;
+		if ((TIFR0 & (1 << TOV0)) && count < UINT8_MAX) {
+			overflows++;
+		}
+		HARD_TIMER_UNLOCK();
+		return (overflows << 8) | count;
+	}
+
+	#define HARD_TIMER_CLOCK() readArduinoClock() // Arduino timer 0 ticks
+	#define HARD_TIMER_CLOCK_FREQ (F_CPU / 64) // clock cycles per second
+#else
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define HARD_TIMER_CPU_FREQ() F_CPU // CPU cycles per second
+	#else
+		#define HARD_TIMER_CPU_FREQ() 0UL // CPU cycles per second
+	#endif
+	#define HARD_TIMER_CLOCK() 0U // no free running clock
+	#define HARD_TIMER_CLOCK_FREQ 0UL // clock cycles per second
+#endif
+
+/**
+ * CPU cycles of delay call and setup taken off busy waits
+ * 
+ * Defaults are estimated from the instructions each backend runs outside
+ * its wait loop. To calibrate a board, add the cycles the
+ * hardTimerDelayTicks(200) benchmark reads over 200 to the default
+ * 
+ * @note waits on a clock coarser than this lose nothing to it
+ */
+#ifndef HARD_TIMER_DELAY_OVERHEAD
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define HARD_TIMER_DELAY_OVERHEAD 28 // call, pushes, 32 bit compare and _delay_loop_2 setup
+	#elif HARDWARE_TIMER_SUPPORT_ESP32
+		#define HARD_TIMER_DELAY_OVERHEAD 16 // call, windowed entry and first CCOUNT read
+	#else
+		#define HARD_TIMER_DELAY_OVERHEAD 12 // call and busy_wait_at_least_cycles setup
+	#endif
+#endif
+
+/**
+ * Missed periods of timers whose counters reload on expiry,
+ * which only a free running clock can count
+ * 
+ * @note opt in with HARD_TIMER_COUNT_MISSED, as reading the clock costs every ISR
+ */
+#if defined(HARD_TIMER_COUNT_MISSED) && !HARDWARE_TIMER_SUPPORT_PICO && HARD_TIMER_CLOCK_FREQ != 0
+	#define HARD_TIMER_CLOCK_MISSED // counts missed periods on free running clock
+	#define HARD_TIMER_CLOCK_SHIFT 16 // fraction bits of clock cycles per tick
+#endif
+
+typedef enum {
+	HARD_TIMER_FUNCTION_VOID, // callback of type hard_timer_function_ptr_t
+	HARD_TIMER_FUNCTION_EVENT, // callback of type hard_timer_event_function_ptr_t
+	HARD_TIMER_FUNCTION_STOPPABLE, // callback of type hard_timer_stoppable_function_ptr_t
+} hard_timer_function_type_t;
+
+// runtime state of a timer
+typedef struct {
+	hard_timer_tick_t deadline; // ticks of next expiry
+	hard_timer_tick_t period; // ticks between expiries
+	uint32_t sequence; // expiries since timer was set
+	uint32_t overruns; // expiries that overran their period
+	uint32_t missed; // periods missed by late expiries
+	uint32_t read; // expiries and missed periods when timer was last read
+	hard_timer_freq_t tickFreq; // ticks per second
+	uint8_t running; // callbacks currently running
+	uint8_t functionType; // hard_timer_function_type_t of callback
+	#ifdef HARD_TIMER_CLOCK_MISSED
+		uint32_t clockScale; // fixed point clock cycles per tick
+		uint32_t clockExpiry; // clock cycles at last expiry
+		hard_timer_tick_t clockDeadline; // deadline of last expiry
+	#endif
+	#if defined(HARD_TIMER_LATENCY_STATS) && HARDWARE_TIMER_SUPPORT_ESP32
+		uint32_t cycleDeadline; // predicted CPU cycle count of next expiry
+		uint32_t cyclePeriod; // CPU cycles between expiries, rounded up
+	#endif
+} hard_timer_info_t;
+
+extern hard_timer_function_ptr_t hardTimerFunctions[HARD_TIMER_COUNT];
+extern void* hardTimerParams[HARD_TIMER_COUNT];
+extern hard_timer_info_t hardTimerInfo[HARD_TIMER_COUNT];
+extern hard_timer_overrun_ptr_t hardTimerOverrunHook;
+
+#ifdef HARD_TIMER_LATENCY_STATS
+	extern hard_timer_latency_t hardTimerLatency[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_PROFILE
+	extern hard_timer_profile_t hardTimerProfile[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_DISCIPLINE
+
+	#ifndef HARD_TIMER_DISCIPLINE_TAU
+		#define HARD_TIMER_DISCIPLINE_TAU 8 // seconds to remove phase error over
+	#endif
+	#ifndef HARD_TIMER_DISCIPLINE_LIMIT_PPB
+		#define HARD_TIMER_DISCIPLINE_LIMIT_PPB 500000L // largest period trim in parts per billion
+	#endif
+	#define HARD_TIMER_DISCIPLINE_SHIFT 2 // offset estimate weighs new errors by 1/2^shift
+	#define HARD_TIMER_TRIM_ONE 65536L // fixed point 1 tick of trim
+
+	// reference clock discipline of a timer
+	typedef struct {
+		hard_timer_tick_t basePeriod; // period before trim
+		int32_t trim; // fixed point ticks added to each period
+		int32_t remainder; // fixed point ticks of trim not applied yet
+		uint64_t refStart; // reference microseconds at first reference
+		uint64_t refLast; // reference microseconds at last reference
+		hard_timer_tick_t ticksLast; // timer ticks at last reference
+		int64_t elapsedStart; // fixed point microseconds of expiries at first reference
+		hard_timer_discipline_t state; // state reported to user
+	} hard_timer_pll_t;
+
+	extern hard_timer_pll_t hardTimerPll[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_SLACK
+
+	// expiry coalescing of a timer
+	typedef struct {
+		hard_timer_tick_t slackTicks; // ticks expiries may move from schedule
+		int32_t shift; // ticks next expiry was moved by, negative when early
+		int32_t offset; // ticks next expiry is moved from its schedule
+		bool trimmed; // period was trimmed but not yet written to hardware
+		hard_timer_slack_t state; // state reported to user
+	} hard_timer_coalesce_t;
+
+	extern hard_timer_coalesce_t hardTimerSlack[HARD_TIMER_COUNT];
+#endif
+
+#ifdef HARD_TIMER_TRACE
+	extern hard_timer_trace_record_t hardTimerTrace[HARD_TIMER_TRACE_SIZE];
+	extern unsigned int hardTimerTraceHead;
+	#if HARDWARE_TIMER_SUPPORT_PICO
+		extern spin_lock_t *hardTimerTraceLock;
+	#endif
+#endif
+
+/**
+ * Sets hardware timer with callback of given type
+ * 
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired frequency in Hz
+ * @param function callback, cast from type given
+ * @param params parameters to pass into callback
+ * @param priority priority of callback from 0 (lowest) to 255 (highest)
+ * @param type hard_timer_function_type_t of callback
+ * 
+ * @return if timer was set
+ */
+bool setHardTimerTyped(hard_timer_enum_t *timer, hard_timer_freq_t *freq, hard_timer_function_ptr_t function, void* params, hard_timer_priority_t priority, hard_timer_function_type_t type);
+
+/**
+ * Sets callback of given type for timer
+ * 
+ * @param timer timer to set
+ * @param function callback, cast from type given
+ * @param params parameters to pass into callback
+ * @param type hard_timer_function_type_t of callback
+ * 
+ * @note callback, parameters and type change together, so running timers never mix them
+ * 
+ * @return if callback was set
+ */
+bool setHardTimerFunctionTyped(hard_timer_enum_t timer, hard_timer_function_ptr_t function, void* params, hard_timer_function_type_t type);
+
+/**
+ * Gets current tick count of timer in the same domain as its deadlines
+ * 
+ * @param timer started timer to get
+ * 
+ * @return ticks of timer
+ */
+hard_timer_tick_t getHardTimerTicks(hard_timer_enum_t timer);
+
+/**
+ * Sets ticks until next expiry, taking effect for the period currently counting
+ * 
+ * @param timer started timer to set
+ * @param period ticks between expiries
+ * 
+ * @note safe to call from timer ISR
+ */
+void setHardTimerPeriod(hard_timer_enum_t timer, hard_timer_tick_t period);
+
+/**
+ * Gets longest period setHardTimerPeriod can set
+ * 
+ * @param timer started timer to get
+ * 
+ * @return ticks of longest period
+ * 
+ * @note safe to call from timer ISR
+ */
+hard_timer_tick_t getHardTimerPeriodMax(hard_timer_enum_t timer);
+
+/**
+ * Stops expiries of timer and marks it stopped
+ * 
+ * @param timer started timer to stop
+ * 
+ * @note called from timer ISR when callback asks to stop
+ */
+void haltHardTimer(hard_timer_enum_t timer);
+
+/**
+ * Resets runtime state of timer before it starts
+ * 
+ * @param timer timer to reset
+ * @param start tick count timer starts at
+ * @param period ticks between expiries
+ * @param tickFreq ticks per second
+ */
+void resetHardTimerInfo(hard_timer_enum_t timer, hard_timer_tick_t start, hard_timer_tick_t period, hard_timer_freq_t tickFreq);
+
+#ifdef HARD_TIMER_TRACE
+
+/**
+ * Claims next trace record index
+ * 
+ * ESP32 has an atomic add. RP2040 has none, so Pico takes a hardware
+ * spin lock claimed for tracing alone, and AVR disables interrupts
+ * 
+ * @return unwrapped record index
+ */
+HARD_TIMER_INLINE unsigned int claimHardTimerTrace() {
+	#if HARDWARE_TIMER_SUPPORT_ESP32
+		return __atomic_fetch_add(&hardTimerTraceHead, 1U, __ATOMIC_RELAXED);
+	#elif HARDWARE_TIMER_SUPPORT_PICO
+		uint32_t state = spin_lock_blocking(hardTimerTraceLock);
+		unsigned int index = hardTimerTraceHead++;
+		spin_unlock(hardTimerTraceLock, state);
+		return index;
+	#else
+		HARD_TIMER_LOCK();
+		unsigned int index = hardTimerTraceHead++;
+		HARD_TIMER_UNLOCK();
+		return index;
+	#endif
+}
+
+/**
+ * Adds event to trace ring buffer
+ * 
+ * Event is cleared before the other fields are written and published
+ * last, so readers skip records that are being written
+ * 
+ * @param num timer number
+ * @param event hard_timer_trace_event_t of event
+ * @param data expiry sequence for fires, missed periods for overruns
+ */
+HARD_TIMER_INLINE void traceHardTimer(uint8_t num, uint8_t event, uint32_t data) {
+	hard_timer_trace_record_t *record = &hardTimerTrace[claimHardTimerTrace() & (HARD_TIMER_TRACE_SIZE - 1)];
+	__atomic_store_n(&record -> event, (uint8_t)HARD_TIMER_TRACE_NONE, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	record -> timestamp = HARD_TIMER_CLOCK();
+	record -> timer = (int8_t)num;
+	record -> data = (uint16_t)data;
+	__atomic_store_n(&record -> event, event, __ATOMIC_RELEASE);
+}
+
+#define HARD_TIMER_TRACE_EVENT(num, event, data) traceHardTimer(num, event, data) // records trace event
+
+#else
+
+#define HARD_TIMER_TRACE_EVENT(num, event, data) // tracing disabled
+
 #endif
 
+/**
+ * Records overrun of timer and calls overrun hook
+ * 
+ * @param num timer number
+ * @param missed whole periods expiry was late by
+ */
+HARD_TIMER_INLINE void recordHardTimerOverrun(uint8_t num, uint32_t missed) {
+	hardTimerInfo[num].overruns++;
+	hardTimerInfo[num].missed += missed;
+	HARD_TIMER_TRACE_EVENT(num, HARD_TIMER_TRACE_OVERRUN, missed);
+	if (hardTimerOverrunHook != NULL) {
+		hardTimerOverrunHook((hard_timer_enum_t)num, missed);
+	}
+}
+
+#ifdef HARD_TIMER_CLOCK_MISSED
+
+/**
+ * Converts timer ticks to free running clock cycles
+ * 
+ * @param num timer number
+ * @param ticks ticks to convert
+ * 
+ * @return clock cycles
+ */
+HARD_TIMER_INLINE uint32_t toHardTimerClock(uint8_t num, hard_timer_tick_t ticks) {
+	return (uint32_t)(((uint64_t)ticks * hardTimerInfo[num].clockScale) >> HARD_TIMER_CLOCK_SHIFT);
+}
+
+/**
+ * Counts periods missed while ISR was blocked and moves deadline past them
+ * 
+ * Counters reload on expiry, so late ticks never reach a period. Time
+ * between expiries is measured on the free running clock instead, from
+ * the expiry itself so conversion errors don't add up
+ * 
+ * @param num timer number
+ * @param late ticks elapsed since expiry
+ * 
+ * @return whole periods missed
+ */
+HARD_TIMER_INLINE uint32_t countHardTimerMissed(uint8_t num, hard_timer_tick_t late) {
+	hard_timer_info_t *info = &hardTimerInfo[num];
+	uint32_t expiry = HARD_TIMER_CLOCK() - toHardTimerClock(num, late);
+	uint32_t missed = 0;
+	if (info -> sequence != 0) {
+		uint32_t expected = toHardTimerClock(num, info -> deadline - info -> clockDeadline);
+		uint32_t period = toHardTimerClock(num, info -> period);
+		uint32_t extra = expiry - info -> clockExpiry - expected;
+		// rounds to whole periods, since moved or trimmed periods convert inexactly
+		if ((int32_t)extra > 0 && period != 0 && extra >= period / 2) {
+			missed = (extra + period / 2) / period;
+			info -> deadline += (hard_timer_tick_t)missed * info -> period;
+		}
+	}
+	info -> clockExpiry = expiry;
+	info -> clockDeadline = info -> deadline;
+	return missed;
+}
+
+#endif
+
+/**
+ * Marks timer callback as running
+ * 
+ * @param num timer number
+ * @param late ticks elapsed since expiry deadline
+ * 
+ * @return whole periods expiry is late by
+ */
+HARD_TIMER_INLINE uint32_t enterHardTimer(uint8_t num, hard_timer_tick_t late) {
+	hard_timer_info_t *info = &hardTimerInfo[num];
+	if (info -> running != 0) {
+		// expired while previous callback still running
+		recordHardTimerOverrun(num, 0);
+	}
+	info -> running++;
+	#ifdef HARD_TIMER_CLOCK_MISSED
+		return countHardTimerMissed(num, late);
+	#else
+		// deadlines are absolute, or there is no clock to count missed periods on
+		if (late >= info -> period) {
+			return (uint32_t)(late / info -> period);
+		}
+		return 0;
+	#endif
+}
+
+#ifdef HARD_TIMER_DISCIPLINE
+
+/**
+ * Dithers period of disciplined timer by its fractional trim
+ * 
+ * @param num timer number
+ */
+HARD_TIMER_INLINE void trimHardTimer(uint8_t num) {
+	hard_timer_pll_t *pll = &hardTimerPll[num];
+	if (pll -> state.references == 0) {
+		return;
+	}
+	pll -> remainder += pll -> trim;
+	int32_t whole = pll -> remainder / HARD_TIMER_TRIM_ONE;
+	if (pll -> remainder < 0 && pll -> remainder % HARD_TIMER_TRIM_ONE != 0) {
+		whole--;
+	}
+	pll -> remainder -= whole * HARD_TIMER_TRIM_ONE;
+
+	hard_timer_tick_t period = pll -> basePeriod + whole;
+	if (period != hardTimerInfo[num].period) {
+		hardTimerInfo[num].period = period;
+		#ifdef HARD_TIMER_SLACK
+			// coalescing writes trimmed period together with its shift
+			hardTimerSlack[num].trimmed = true;
+		#else
+			setHardTimerPeriod((hard_timer_enum_t)num, period);
+		#endif
+	}
+}
+
+#define HARD_TIMER_TRIM(num) trimHardTimer(num) // trims next period
+
+#else
+
+#define HARD_TIMER_TRIM(num) // discipline disabled
+
+#endif
+
+/**
+ * Marks timer callback as finished, records overruns and advances timer state
+ * 
+ * @param num timer number
+ * @param missed whole periods expiry was late by
+ * @param overdue if next expiry was due before callback finished
+ */
+HARD_TIMER_INLINE void exitHardTimer(uint8_t num, uint32_t missed, bool overdue) {
+	hard_timer_info_t *info = &hardTimerInfo[num];
+	info -> running--;
+	if (missed != 0 || overdue) {
+		recordHardTimerOverrun(num, missed);
+	}
+	HARD_TIMER_TRIM(num);
+	info -> deadline += info -> period;
+	info -> sequence++;
+}
+
+#ifdef HARD_TIMER_LATENCY_STATS
+
+#if HARDWARE_TIMER_SUPPORT_ESP32
+
+/**
+ * Gets latency in CPU cycles from predicted expiry
+ * 
+ * Timer counters are too coarse for latency, so deadlines are
+ * predicted in CPU cycles and anchored to the earliest entry seen
+ * 
+ * @param num timer number
+ * @param late unused, ticks elapsed since expiry deadline
+ * 
+ * @return CPU cycles since predicted expiry
+ */
+HARD_TIMER_INLINE uint32_t getHardTimerLatencyCycles(uint8_t num, hard_timer_tick_t late) {
+	hard_timer_info_t *info = &hardTimerInfo[num];
+	uint32_t now = HARD_TIMER_CYCLES();
+	uint32_t latency = now - info -> cycleDeadline;
+	if (info -> sequence == 0 || (int32_t)latency < 0) {
+		info -> cycleDeadline = now;
+		latency = 0;
+	}
+	info -> cycleDeadline += info -> cyclePeriod;
+	return latency;
+}
+
+#else
+
+/**
+ * Gets latency in timer ticks
+ * 
+ * @param num timer number
+ * @param late ticks elapsed since expiry deadline
+ * 
+ * @return latency clock cycles since expiry
+ */
+#define getHardTimerLatencyCycles(num, late) ((late) > UINT32_MAX ? UINT32_MAX : (uint32_t)(late))
+
+#endif
+
+/**
+ * Adds latency to histogram of timer
+ * 
+ * @param num timer number
+ * @param latency latency clock cycles since expiry
+ */
+HARD_TIMER_INLINE void recordHardTimerLatency(uint8_t num, uint32_t latency) {
+	hard_timer_latency_t *stats = &hardTimerLatency[num];
+	uint8_t bucket = 0;
+	if (latency != 0) {
+		bucket = (uint8_t)(sizeof(unsigned long) * 8 - __builtin_clzl((unsigned long)latency));
+		if (bucket >= HARD_TIMER_LATENCY_BUCKETS) {
+			bucket = HARD_TIMER_LATENCY_BUCKETS - 1;
+		}
+	}
+	stats -> buckets[bucket]++;
+	if (latency < stats -> min || stats -> count == 0) {
+		stats -> min = latency;
+	}
+	if (latency > stats -> max) {
+		stats -> max = latency;
+	}
+	stats -> total += latency;
+	stats -> count++;
+}
+
+/**
+ * Records latency of expiry
+ * 
+ * @param num timer number
+ * @param late ticks elapsed since expiry deadline
+ */
+#define HARD_TIMER_RECORD_LATENCY(num, late) recordHardTimerLatency(num, getHardTimerLatencyCycles(num, late))
+
+#else
+
+#define HARD_TIMER_RECORD_LATENCY(num, late) // latency stats disabled
+
+#endif
+
+#ifdef HARD_TIMER_PROFILE
+
+#ifndef HARD_TIMER_PROFILE_EMA_SHIFT
+	#define HARD_TIMER_PROFILE_EMA_SHIFT 3 // moving average weighs new durations by 1/2^shift
+#endif
+
+/**
+ * Reads profile clock
+ * 
+ * @param late expression for ticks elapsed since expiry deadline,
+ * re-evaluated to read the timer counter on AVR and Pico
+ * 
+ * @return profile clock cycles
+ */
+#if HARDWARE_TIMER_SUPPORT_ESP32
+	#define HARD_TIMER_PROFILE_CLOCK(late) HARD_TIMER_CYCLES()
+#elif HARDWARE_TIMER_SUPPORT_PICO && defined(HARD_TIMER_PICO_SYSTICK)
+	#include <hardware/structs/systick.h>
+	#define HARD_TIMER_SYSTICK_MASK 0xFFFFFFUL // SysTick counts down through 24 bits
+	#define HARD_TIMER_PROFILE_CLOCK(late) ((uint32_t)(HARD_TIMER_SYSTICK_MASK - systick_hw -> cvr))
+#else
+	#define HARD_TIMER_PROFILE_CLOCK(late) ((uint32_t)(late))
+#endif
+
+/**
+ * Adds callback duration to profile of timer
+ * 
+ * @param num timer number
+ * @param start profile clock before callback
+ * @param end profile clock after callback
+ * 
+ * @note average is stored scaled by 2^HARD_TIMER_PROFILE_EMA_SHIFT
+ */
+HARD_TIMER_INLINE void recordHardTimerProfile(uint8_t num, uint32_t start, uint32_t end) {
+	hard_timer_profile_t *profile = &hardTimerProfile[num];
+	uint32_t duration = end - start;
+	#if HARDWARE_TIMER_SUPPORT_PICO && defined(HARD_TIMER_PICO_SYSTICK)
+		// SysTick wraps within 24 bits
+		duration &= HARD_TIMER_SYSTICK_MASK;
+	#elif !HARDWARE_TIMER_SUPPORT_ESP32
+		if (end < start) {
+			// counter cleared on compare match while callback ran
+			duration += (uint32_t)hardTimerInfo[num].period;
+		}
+	#endif
+	profile -> last = duration;
+	if (duration > profile -> max) {
+		profile -> max = duration;
+	}
+	if (profile -> count == 0) {
+		profile -> average = duration << HARD_TIMER_PROFILE_EMA_SHIFT;
+	}
+	else {
+		profile -> average += duration - (profile -> average >> HARD_TIMER_PROFILE_EMA_SHIFT);
+	}
+	profile -> total += duration;
+	profile -> count++;
+}
+
+#define HARD_TIMER_PROFILE_START(late) uint32_t profileStart = HARD_TIMER_PROFILE_CLOCK(late) // reads clock before callback
+#define HARD_TIMER_PROFILE_END(num, late) recordHardTimerProfile(num, profileStart, HARD_TIMER_PROFILE_CLOCK(late)) // records callback duration
+
+#else
+
+#define HARD_TIMER_PROFILE_START(late) // profiling disabled
+#define HARD_TIMER_PROFILE_END(num, late) // profiling disabled
+
+#endif
+
+/**
+ * Calls event function of timer
+ * 
+ * @param num timer number
+ * @param late ticks elapsed since expiry deadline
+ * @param missed whole periods expiry is late by
+ */
+HARD_TIMER_INLINE void runHardTimerEvent(uint8_t num, hard_timer_tick_t late, uint32_t missed) {
+	hard_timer_info_t *info = &hardTimerInfo[num];
+	hard_timer_event_t event = {
+		.timestamp = info -> deadline + late,
+		.deadline = info -> deadline,
+		.period = info -> period,
+		.sequence = info -> sequence,
+		.missed = missed,
+	};
+	((hard_timer_event_function_ptr_t)hardTimerFunctions[num])(&event, hardTimerParams[num]);
+}
+
+#ifdef HARD_TIMER_SLACK
+
+/**
+ * Moves next expiry of timer onto next expiry of another timer within its slack
+ * 
+ * @param num timer number, after its deadline advanced
+ */
+void coalesceHardTimer(uint8_t num);
+
+#define HARD_TIMER_COALESCE(num) coalesceHardTimer(num) // aligns next expiry
+
+#else
+
+#define HARD_TIMER_COALESCE(num) // coalescing disabled
+
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_AVR && !defined(HARD_TIMER_AVR_LEAN)
+	#define HARD_TIMER_AVR_LEAN 0 // bits of timers with ISRs defined outside of library
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_AVR && defined(HARD_TIMER_AVR_NESTED)
+
+#ifndef HARD_TIMER_AVR_PREEMPT_PRIORITY
+	#define HARD_TIMER_AVR_PREEMPT_PRIORITY 128 // timers set below this priority can be preempted
+#endif
+
+/**
+ * Masks interrupts of timers at or below priority of low priority timer
+ * and enables interrupts for its callback
+ * 
+ * @param num timer number
+ * 
+ * @return if interrupts were enabled
+ */
+bool nestHardTimerEnter(uint8_t num);
+
+/**
+ * Disables interrupts after a preemptible callback and unmasks timers it masked
+ * 
+ * @param num timer number
+ */
+void nestHardTimerExit(uint8_t num);
+
+#define HARD_TIMER_NEST_ENTER(num) bool nested = nestHardTimerEnter(num) // lets higher priority timers preempt callback
+#define HARD_TIMER_NEST_EXIT(num) if (nested) { nestHardTimerExit(num); } // ends preemption of callback
+
+#else
+
+#define HARD_TIMER_NEST_ENTER(num) // callbacks run with interrupts disabled
+#define HARD_TIMER_NEST_EXIT(num) // callbacks run with interrupts disabled
+
+#endif
+
+/**
+ * Runs timer callback from ISR and advances timer state
+ * 
+ * @param num timer number
+ * @param late expression for ticks elapsed since expiry deadline
+ * @param OVERDUE macro taking (num, late) that tests
+ * if next expiry became due while callback ran
+ */
+#define HARD_TIMER_DISPATCH(num, late, OVERDUE) { \
+	hard_timer_tick_t lateTicks = (late); \
+	HARD_TIMER_RECORD_LATENCY(num, lateTicks); \
+	uint32_t missedPeriods = enterHardTimer(num, lateTicks); \
+	HARD_TIMER_TRACE_EVENT(num, HARD_TIMER_TRACE_FIRE, hardTimerInfo[num].sequence); \
+	HARD_TIMER_PROFILE_START(late); \
+	HARD_TIMER_NEST_ENTER(num); \
+	bool keepRunning = true; \
+	if (hardTimerInfo[num].functionType == HARD_TIMER_FUNCTION_EVENT) { \
+		runHardTimerEvent(num, lateTicks, missedPeriods); \
+	} \
+	else if (hardTimerInfo[num].functionType == HARD_TIMER_FUNCTION_STOPPABLE) { \
+		keepRunning = ((hard_timer_stoppable_function_ptr_t)hardTimerFunctions[num])(hardTimerParams[num]); \
+	} \
+	else { \
+		((void(*)())hardTimerFunctions[num])(hardTimerParams[num]); \
+	} \
+	HARD_TIMER_NEST_EXIT(num); \
+	HARD_TIMER_PROFILE_END(num, late); \
+	exitHardTimer(num, missedPeriods, OVERDUE(num, lateTicks)); \
+	HARD_TIMER_COALESCE(num); \
+	if (!keepRunning) { \
+		haltHardTimer((hard_timer_enum_t)(num)); \
+	} \
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+/*
+	hardware_timer_benchmark.c - measures dispatch and API overhead of timers
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "hardware_timer_test_priv.h"
+#include "../private/hardware_timer_priv.h"
+
+// no free running clock to time with on AVR without Arduino timer 0
+#if HARD_TIMER_COUNT > 0 && HARD_TIMER_CLOCK_FREQ != 0
+
+#ifndef BENCH_REPETITIONS
+	#define BENCH_REPETITIONS 8 // repetitions of each benchmark
+#endif
+#define BENCH_API_OPS 64 // API calls timed together
+#define BENCH_SET_OPS 8 // set and cancel pairs timed together
+#define BENCH_WINDOW_MS 100 // window for counting idle loops
+#define BENCH_DELAY_TICKS 200 // CPU cycles of timed delay
+
+#if HARD_TIMER_FREQ_MAX > 10000
+	#define BENCH_EXPIRY_FREQ 10000 // frequency of timer for expiry cost
+#else
+	#define BENCH_EXPIRY_FREQ HARD_TIMER_FREQ_MAX // frequency of timer for expiry cost
+#endif
+
+// clock cycles in idle loop window
+#define BENCH_WINDOW ((uint32_t)((uint64_t)HARD_TIMER_CLOCK_FREQ * BENCH_WINDOW_MS / 1000))
+
+#ifdef HARD_TIMER_CYCLES
+	#define BENCH_API_CLOCK() HARD_TIMER_CYCLES() // times API calls in CPU cycles
+	#define BENCH_API_CYCLES(elapsed) ((uint64_t)(elapsed)) // already CPU cycles
+#else
+	#define BENCH_API_CLOCK() HARD_TIMER_CLOCK() // times API calls on free running clock
+	#define BENCH_API_CYCLES(elapsed) benchCycles(elapsed) // converts clock cycles to CPU cycles
+#endif
+
+#if HARDWARE_TIMER_SUPPORT_AVR && (defined(BENCH_AVR_LEAN) || defined(BENCH_AVR_NAKED))
+	#if !(HARD_TIMER_AVR_LEAN & 1)
+		#error "lean benchmarks need bit of HARD_TIMER0 set in HARD_TIMER_AVR_LEAN"
+	#endif
+	#define BENCH_LEAN_TIMER HARD_TIMER0 // timer with ISR defined by benchmark
+#endif
+
+volatile uint16_t benchCount = 0U; // expiries of benchmark timer
+volatile bool benchSink = false; // keeps results of timed calls
+
+/**
+ * Counts expiries of benchmark timer
+ * 
+ * @param params pointer to expiry count
+ */
+void HARD_TIMER_RAM_ATTR(benchFunction) benchFunction(void *params) {
+	*(volatile uint16_t*)params += 1;
+}
+
+#if defined(BENCH_LEAN_TIMER) && defined(BENCH_AVR_NAKED)
+
+HARD_TIMER_AVR_NAKED_COUNT(0, benchCount)
+
+#elif defined(BENCH_LEAN_TIMER)
+
+/**
+ * Counts expiries of lean benchmark timer
+ */
+static inline void benchLeanFunction() {
+	benchCount++;
+}
+
+HARD_TIMER_AVR_LEAN_CALLBACK(0, benchLeanFunction)
+
+#endif
+
+/**
+ * Converts clock cycles to CPU cycles
+ * 
+ * @param clock clock cycles elapsed
+ * 
+ * @return CPU cycles elapsed
+ */
+uint64_t benchCycles(uint32_t clock) {
+	return (uint64_t)clock * HARD_TIMER_CPU_FREQ() / HARD_TIMER_CLOCK_FREQ;
+}
+
+/**
+ * Adds cost of one repetition to result
+ * 
+ * @param result result to add to
+ * @param cycles CPU cycles per operation
+ */
+void benchAdd(hard_timer_bench_t *result, uint32_t cycles) {
+	if (result -> repetitions == 0 || cycles < result -> minCycles) {
+		result -> minCycles = cycles;
+	}
+	if (cycles > result -> maxCycles) {
+		result -> maxCycles = cycles;
+	}
+	// mean is summed here and divided in benchFinish
+	result -> meanCycles += cycles;
+	result -> repetitions++;
+}
+
+/**
+ * Finishes result and prints it
+ * 
+ * @param name name of benchmark
+ * @param result result to print
+ */
+void benchFinish(const char *name, hard_timer_bench_t *result) {
+	if (result -> repetitions != 0) {
+		result -> meanCycles /= result -> repetitions;
+	}
+	result -> meanNs = (uint32_t)((uint64_t)result -> meanCycles * 1000000000ULL / HARD_TIMER_CPU_FREQ());
+	printBenchmarkResult(name, result);
+}
+
+/**
+ * Counts idle loops run within window
+ * 
+ * @return loops counted
+ */
+uint32_t benchIdleLoops() {
+	uint32_t loops = 0U;
+	uint32_t start = HARD_TIMER_CLOCK();
+	while ((uint32_t)(HARD_TIMER_CLOCK() - start) < BENCH_WINDOW) {
+		loops++;
+		__asm__ __volatile__ ("nop");
+	}
+	return loops;
+}
+
+/**
+ * Measures full cost of one expiry with idle loops it steals
+ * 
+ * Cost covers interrupt entry and exit, trampoline, indirect call
+ * and parameter loading of the callback
+ * 
+ * @param name name of benchmark
+ * @param first timer to measure, or HARD_TIMER_INVALID for any
+ */
+void benchExpiry(const char *name, hard_timer_enum_t first) {
+	hard_timer_bench_t result = {0};
+
+	for (uint8_t i = 0; i < BENCH_REPETITIONS; i++) {
+		hard_timer_enum_t timer = first;
+		hard_timer_freq_t freq = BENCH_EXPIRY_FREQ;
+
+		uint32_t idleLoops = benchIdleLoops();
+		benchCount = 0U;
+		if (!setHardTimer(&timer, &freq, &benchFunction, (void*)&benchCount, HARD_TIMER_PRIORITY_DEFAULT)) {
+			return;
+		}
+		uint32_t busyLoops = benchIdleLoops();
+		cancelHardTimer(timer);
+		uint32_t expiries = benchCount;
+
+		if (expiries == 0 || busyLoops > idleLoops) {
+			// nothing measurable, so repetition is left out of result
+			continue;
+		}
+		uint64_t stolen = benchCycles(BENCH_WINDOW) * (idleLoops - busyLoops) / idleLoops;
+		benchAdd(&result, (uint32_t)(stolen / expiries));
+	}
+	result.ops = BENCH_EXPIRY_FREQ * BENCH_WINDOW_MS / 1000;
+	benchFinish(name, &result);
+}
+
+/**
+ * Times repeated API calls
+ * 
+ * @param name name of benchmark
+ * @param opCount calls per repetition
+ * @param op function to call, inlined into timed loop
+ */
+#define BENCH_API(name, opCount, op) { \
+	hard_timer_bench_t result = {0}; \
+	for (uint8_t i = 0; i < BENCH_REPETITIONS; i++) { \
+		uint32_t start = BENCH_API_CLOCK(); \
+		for (uint16_t j = 0; j < (opCount); j++) { \
+			op(); \
+		} \
+		uint32_t elapsed = BENCH_API_CLOCK() - start; \
+		benchAdd(&result, (uint32_t)(BENCH_API_CYCLES(elapsed) / (opCount))); \
+	} \
+	result.ops = (opCount); \
+	benchFinish(name, &result); \
+}
+
+/**
+ * Tests if first timer is started
+ */
+HARD_TIMER_INLINE void benchStarted() {
+	benchSink = hardTimerStarted(HARD_TIMER0);
+}
+
+/**
+ * Claims and unclaims any timer
+ */
+HARD_TIMER_INLINE void benchClaim() {
+	hard_timer_claim_s claim = {0};
+	benchSink = unclaimTimer(claimTimer(&claim));
+}
+
+/**
+ * Sets and cancels any timer
+ */
+HARD_TIMER_INLINE void benchSet() {
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = BENCH_EXPIRY_FREQ;
+	setHardTimer(&timer, &freq, &benchFunction, (void*)&benchCount, HARD_TIMER_PRIORITY_DEFAULT);
+	benchSink = cancelHardTimer(timer);
+}
+
+/**
+ * Reads timestamp
+ */
+HARD_TIMER_INLINE void benchNow() {
+	benchSink = hardTimerNow() != 0;
+}
+
+/**
+ * Waits BENCH_DELAY_TICKS, so result matches it when delay overhead is calibrated
+ */
+HARD_TIMER_INLINE void benchDelay() {
+	hardTimerDelayTicks(BENCH_DELAY_TICKS);
+}
+
+void benchmarkTimers() {
+	printBenchmarkResult(NULL, NULL);
+
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		cancelHardTimer((hard_timer_enum_t)i);
+		unclaimTimer((hard_timer_enum_t)i);
+	}
+
+	benchExpiry("expiry", HARD_TIMER_INVALID);
+	#if defined(BENCH_LEAN_TIMER) && defined(BENCH_AVR_NAKED)
+		benchExpiry("expiry (naked)", BENCH_LEAN_TIMER);
+	#elif defined(BENCH_LEAN_TIMER)
+		benchExpiry("expiry (lean)", BENCH_LEAN_TIMER);
+	#endif
+	BENCH_API("hardTimerStarted", BENCH_API_OPS, benchStarted);
+	BENCH_API("claimTimer+unclaimTimer", BENCH_API_OPS, benchClaim);
+	BENCH_API("setHardTimer+cancelHardTimer", BENCH_SET_OPS, benchSet);
+	BENCH_API("hardTimerNow", BENCH_API_OPS, benchNow);
+	BENCH_API("hardTimerDelayTicks(200)", BENCH_API_OPS, benchDelay);
+}
+
+#else
+
+void benchmarkTimers() {
+	printBenchmarkResult(NULL, NULL);
+}
+
+#endif
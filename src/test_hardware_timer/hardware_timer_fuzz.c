@@ -0,0 +1,290 @@
+/*
+	hardware_timer_fuzz.c - checks claim and start state machine against a model
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "hardware_timer_test_priv.h"
+
+#if HARD_TIMER_COUNT > 0
+
+#define FUZZ_FREQ 100 // frequency every timer can run at
+#define FUZZ_OP_SIZE 2 // input bytes per operation
+
+#if HARDWARE_TIMER_SUPPORT_AVR && defined(HARD_TIMER_AVR_COMPARE_B)
+	#define FUZZ_COMPARE_B // models compare B timers sharing hardware
+#endif
+
+// operations decoded from input
+typedef enum {
+	FUZZ_CLAIM,
+	FUZZ_UNCLAIM,
+	FUZZ_SET,
+	FUZZ_CANCEL,
+	FUZZ_SET_FUNCTION,
+	FUZZ_OP_COUNT
+} fuzz_op_t;
+
+// expected state of every timer
+typedef struct {
+	bool claimed[HARD_TIMER_COUNT]; // timers claimed
+	bool started[HARD_TIMER_COUNT]; // timers started
+} fuzz_model_t;
+
+/**
+ * Callback of fuzzed timers
+ * 
+ * @param params unused
+ */
+void HARD_TIMER_RAM_ATTR(fuzzFunction) fuzzFunction(void *params) {
+	(void)params;
+}
+
+/**
+ * Tests if model could start timer when it is asked for directly
+ * 
+ * @param model model to test
+ * @param timer valid timer to test
+ * 
+ * @return if timer can start
+ */
+bool fuzzStartable(const fuzz_model_t *model, hard_timer_enum_t timer) {
+	if (model -> started[timer]) {
+		return false;
+	}
+	#ifdef FUZZ_COMPARE_B
+		// compare B counts on compare A, which can't restart under it
+		if (timer >= HARD_TIMER_HARDWARE_COUNT) {
+			return model -> started[timer - HARD_TIMER_HARDWARE_COUNT];
+		}
+		return !model -> started[HARD_TIMER_COMPARE_B(timer)];
+	#else
+		return true;
+	#endif
+}
+
+/**
+ * Tests if model could pick timer as best timer
+ * 
+ * @param model model to test
+ * @param timer timer to test
+ * 
+ * @return if timer is unclaimed, not lean and can start
+ */
+bool fuzzFree(const fuzz_model_t *model, hard_timer_enum_t timer) {
+	if (timer == HARD_TIMER_INVALID || timer >= HARD_TIMER_COUNT || TEST_LEAN_TIMER(timer)) {
+		return false;
+	}
+	return !model -> claimed[timer] && fuzzStartable(model, timer);
+}
+
+/**
+ * Tests if model could claim timer
+ * 
+ * @param model model to test
+ * @param timer valid timer to test
+ * 
+ * @return if timer is unclaimed, not lean and its hardware is free
+ */
+bool fuzzClaimable(const fuzz_model_t *model, hard_timer_enum_t timer) {
+	if (model -> claimed[timer] || model -> started[timer] || TEST_LEAN_TIMER(timer)) {
+		return false;
+	}
+	#ifdef FUZZ_COMPARE_B
+		// compare A can't be claimed while its compare B runs
+		if (timer < HARD_TIMER_HARDWARE_COUNT) {
+			return !model -> started[HARD_TIMER_COMPARE_B(timer)];
+		}
+	#endif
+	return true;
+}
+
+/**
+ * Tests if model has any timer to pick as best timer
+ * 
+ * @param model model to test
+ * 
+ * @return if any timer is free
+ */
+bool fuzzAnyFree(const fuzz_model_t *model) {
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (fuzzFree(model, (hard_timer_enum_t)i)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks setHardTimer against its documented table
+ * 
+ * @param model model to check against and update
+ * @param timer timer asked for
+ * 
+ * @return if result matched model
+ */
+bool fuzzSet(fuzz_model_t *model, hard_timer_enum_t timer) {
+	hard_timer_enum_t setTimer = timer;
+	hard_timer_freq_t freq = FUZZ_FREQ;
+	bool set = setHardTimer(&setTimer, &freq, &fuzzFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT);
+
+	bool best = timer == HARD_TIMER_INVALID;
+	if (!best) {
+		if (model -> started[timer]) {
+			if (model -> claimed[timer]) {
+				return !set;
+			}
+			best = true;
+		}
+		else if (fuzzStartable(model, timer)) {
+			if (!set || setTimer != timer) {
+				return false;
+			}
+		}
+		#ifdef FUZZ_COMPARE_B
+			else if (timer >= HARD_TIMER_HARDWARE_COUNT || model -> claimed[timer]) {
+				// compare B without compare A, or claimed compare A under its compare B, never falls back
+				return !set;
+			}
+		#endif
+		else {
+			best = true;
+		}
+	}
+
+	if (best) {
+		if (set != fuzzAnyFree(model)) {
+			return false;
+		}
+		if (set && !fuzzFree(model, setTimer)) {
+			return false;
+		}
+	}
+	if (set) {
+		model -> started[setTimer] = true;
+	}
+	return true;
+}
+
+/**
+ * Runs one decoded operation and checks it against model
+ * 
+ * @param model model to check against and update
+ * @param op operation to run
+ * @param timer timer to run operation on
+ * 
+ * @return if result matched model
+ */
+bool fuzzOperation(fuzz_model_t *model, fuzz_op_t op, hard_timer_enum_t timer) {
+	bool valid = timer != HARD_TIMER_INVALID;
+
+	switch (op) {
+		case FUZZ_CLAIM: {
+			hard_timer_claim_s claim = {0};
+			claim.slowestTimer = (timer & 1) != 0;
+			claim.mostAccurateTimer = (timer & 2) != 0;
+
+			hard_timer_enum_t claimed = claimTimer(&claim);
+			if (claimed == HARD_TIMER_INVALID) {
+				// claims skip busy and lean timers only
+				for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+					if (fuzzClaimable(model, (hard_timer_enum_t)i)) {
+						return false;
+					}
+				}
+				return true;
+			}
+			if (claimed >= HARD_TIMER_COUNT || !fuzzClaimable(model, claimed)) {
+				return false;
+			}
+			model -> claimed[claimed] = true;
+			return true;
+		}
+		case FUZZ_UNCLAIM: {
+			bool expected = valid && model -> claimed[timer];
+			if (unclaimTimer(timer) != expected) {
+				return false;
+			}
+			if (valid) {
+				model -> claimed[timer] = false;
+			}
+			return true;
+		}
+		case FUZZ_SET:
+			return fuzzSet(model, timer);
+		case FUZZ_CANCEL: {
+			bool expected = valid && model -> started[timer];
+			if (cancelHardTimer(timer) != expected) {
+				return false;
+			}
+			if (valid) {
+				model -> started[timer] = false;
+			}
+			return true;
+		}
+		case FUZZ_SET_FUNCTION:
+			return setHardTimerFunction(timer, &fuzzFunction, NULL) == valid;
+		default:
+			return true;
+	}
+}
+
+/**
+ * Stops and unclaims every timer
+ */
+void fuzzReset() {
+	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		cancelHardTimer((hard_timer_enum_t)i);
+		unclaimTimer((hard_timer_enum_t)i);
+	}
+}
+
+bool fuzzHardTimerStates(const uint8_t *data, size_t size) {
+	fuzz_model_t model = {0};
+	bool matched = true;
+
+	fuzzReset();
+
+	for (size_t i = 0; matched && i + FUZZ_OP_SIZE <= size; i += FUZZ_OP_SIZE) {
+		fuzz_op_t op = (fuzz_op_t)(data[i] % FUZZ_OP_COUNT);
+		uint8_t index = data[i + 1] % (HARD_TIMER_COUNT + 1);
+		hard_timer_enum_t timer = index == HARD_TIMER_COUNT ? HARD_TIMER_INVALID : (hard_timer_enum_t)index;
+
+		matched = fuzzOperation(&model, op, timer);
+
+		// every timer state is compared, not just the one touched
+		for (uint8_t j = 0; matched && j < HARD_TIMER_COUNT; j++) {
+			if (hardTimerClaimed((hard_timer_enum_t)j) != model.claimed[j]) {
+				matched = false;
+			}
+			if (hardTimerStarted((hard_timer_enum_t)j) != model.started[j]) {
+				matched = false;
+			}
+		}
+	}
+
+	fuzzReset();
+	return matched;
+}
+
+#else
+
+bool fuzzHardTimerStates(const uint8_t *data, size_t size) {
+	(void)data;
+	(void)size;
+	return true;
+}
+
+#endif
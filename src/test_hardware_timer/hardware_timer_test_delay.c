@@ -28,11 +28,18 @@ void delaySeconds(uint8_t seconds) {
 	delay(seconds * 1000);
 }
 
+#elif !HARDWARE_TIMER_SUPPORT_AVR
+
+void delaySeconds(uint8_t seconds) {
+	// waits on clocks that keep counting through interrupts
+	for (uint8_t i = 0; i < seconds; i++) {
+		hardTimerDelayUs(1000000UL);
+	}
+}
+
 #else
 
-#if HARDWARE_TIMER_SUPPORT_AVR
-	#include "../avr/hardware_timer_avr.h"
-#endif
+#include "../avr/hardware_timer_avr.h"
 
 /**
  * Interrupt function for delay
@@ -47,12 +54,7 @@ void delaySeconds(uint8_t seconds) {
 	hard_timer_enum_t timer = HARD_TIMER_INVALID;
 	volatile uint8_t delayCount = 0U;
 
-	hard_timer_freq_t freq =
-	#ifdef FREQ_MIN_8_COUNTER
-		FREQ_MIN_8_COUNTER;
-	#else
-		1;
-	#endif
+	hard_timer_freq_t freq = FREQ_MIN_8_COUNTER;
 
 	if (!setHardTimer(&timer, &freq, &timerDelayCounter, (void*)&delayCount, HARD_TIMER_PRIORITY_DEFAULT)) {
 		cancelHardTimer(timer);
@@ -17,6 +17,7 @@
 */
 
 #include "hardware_timer_test_priv.h"
+#include "../private/hardware_timer_priv.h"
 
 #if defined(USE_UNITY)
 	#warning "Testing hardware_timer with Unity"
@@ -46,6 +47,58 @@
 
 #define TEST_DELAY_ELLAPSE_S 1 // time for timer to run for
 
+#define TEST_DELAY_US 500 // busy wait to time
+#ifndef DELAY_TEST_BUFFER_US
+	#define DELAY_TEST_BUFFER_US 20 // amount busy wait can be off of goal
+#endif
+
+#define TEST_STOP_EXPIRIES 3 // expiries before callback stops its timer
+
+#define TEST_PREEMPT_FREQ 1000 // frequency of timer preempting a slow callback
+#define TEST_PREEMPT_SPIN_US 5000 // busy wait of slow callback
+
+#define TEST_REPLAY_MS 30 // span of replayed records
+#define TEST_REPLAY_SPEEDUP 2 // times faster than recorded to replay
+#define TEST_REPLAY_FREQ 100 // frequency of replayed event timer, 10ms periods
+#define TEST_REPLAY_LATE 30 // lateness of replayed fire in percent of period
+
+#define STATS_TEST_MIN_PERIODS 2 // fewest periods to get statistics from
+#ifndef STATS_TEST_WINDOW_MS
+	#define STATS_TEST_WINDOW_MS 1000 // time each swept frequency runs for
+#endif
+#ifndef STATS_TEST_FREQS
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define STATS_TEST_FREQS {10, 100, 1000} // frequencies swept, timestamping costs too much above
+	#else
+		#define STATS_TEST_FREQS {10, 100, 1000, 10000} // frequencies swept
+	#endif
+#endif
+#ifndef STATS_TEST_JITTER_NS
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define STATS_TEST_JITTER_NS 4000 // largest standard deviation of periods, one timestamp tick
+	#else
+		#define STATS_TEST_JITTER_NS 5000 // largest standard deviation of periods
+	#endif
+#endif
+#ifndef STATS_TEST_DEVIATION_NS
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define STATS_TEST_DEVIATION_NS 16000 // largest period deviation, includes Arduino timer 0 interrupts
+	#elif HARDWARE_TIMER_SUPPORT_ESP32
+		#define STATS_TEST_DEVIATION_NS 50000 // largest period deviation, includes flash cache misses
+	#else
+		#define STATS_TEST_DEVIATION_NS 20000 // largest period deviation
+	#endif
+#endif
+#ifndef STATS_TEST_DRIFT_PPM
+	#define STATS_TEST_DRIFT_PPM 100 // largest drift of summed periods
+#endif
+
+#define FUZZ_TEST_SEED 0x2545F491UL // seed of generated operations
+#define FUZZ_TEST_BYTES 64 // bytes generated per fuzzed sequence
+#ifndef FUZZ_TEST_SEQUENCES
+	#define FUZZ_TEST_SEQUENCES 256 // fuzzed sequences run
+#endif
+
 #ifndef SLOW_TEST_BUFFER
 	#define SLOW_TEST_BUFFER 0 // amount slow timer can be off of goal
 #endif
@@ -53,8 +106,6 @@
 	#define FAST_TEST_BUFFER 0 // amount fast timer can be off of goal
 #endif
 
-#define HARD_TIMER_RAM_ATTR(funcName)
-
 /**
  * Tests if timer is invalid timer or not
  */
@@ -98,6 +149,37 @@ memCharString cancelLoopFail[] PROG_FLASH = {"Cancel Loop"};
 memCharString cancelInvalidFail[] PROG_FLASH = {"Cancel Invalid"};
 memCharString startedLoopFail[] PROG_FLASH = {"Started Loop"};
 memCharString didntStopFail[] PROG_FLASH = {"Didn't Stop"};
+memCharString eventFail[] PROG_FLASH = {"Event Info"};
+memCharString noEventFail[] PROG_FLASH = {"No Event"};
+memCharString overrunInvalidFail[] PROG_FLASH = {"Overrun Invalid"};
+memCharString overrunStatsFail[] PROG_FLASH = {"Overrun Stats"};
+memCharString overrunFail[] PROG_FLASH = {"Overrun"};
+memCharString preemptIgnore[] PROG_FLASH = {"Nested Interrupts Disabled"};
+memCharString preemptFail[] PROG_FLASH = {"No Preemption"};
+memCharString selfStopFail[] PROG_FLASH = {"Callback Stop"};
+memCharString readFail[] PROG_FLASH = {"Polled Expiries"};
+memCharString readyFail[] PROG_FLASH = {"Ready Mask"};
+memCharString latencyIgnore[] PROG_FLASH = {"Latency Stats Disabled"};
+memCharString latencyFail[] PROG_FLASH = {"Latency Stats"};
+memCharString profileIgnore[] PROG_FLASH = {"Profiling Disabled"};
+memCharString profileFail[] PROG_FLASH = {"Callback Profile"};
+memCharString toggleFail[] PROG_FLASH = {"Toggle Frequency"};
+memCharString compareBFail[] PROG_FLASH = {"Compare B Divider"};
+memCharString disciplineIgnore[] PROG_FLASH = {"Discipline Disabled"};
+memCharString disciplineFail[] PROG_FLASH = {"Discipline State"};
+memCharString slackIgnore[] PROG_FLASH = {"Slack Disabled"};
+memCharString slackFail[] PROG_FLASH = {"Shared Wakeups"};
+memCharString traceIgnore[] PROG_FLASH = {"Tracing Disabled"};
+memCharString traceFail[] PROG_FLASH = {"Trace Records"};
+memCharString replayFail[] PROG_FLASH = {"Replay Order"};
+memCharString delayIgnore[] PROG_FLASH = {"No Clock To Time Delay"};
+memCharString nowIgnore[] PROG_FLASH = {"No Timestamp Counter"};
+memCharString nowFail[] PROG_FLASH = {"Timestamp Not Monotonic"};
+memCharString statsCountFail[] PROG_FLASH = {"Too Few Periods"};
+memCharString jitterFail[] PROG_FLASH = {"Period Jitter"};
+memCharString deviationFail[] PROG_FLASH = {"Period Deviation"};
+memCharString driftFail[] PROG_FLASH = {"Period Drift"};
+memCharString stateMachineFail[] PROG_FLASH = {"State Machine Model"};
 
 /**
  * Priority claim statements
@@ -131,6 +213,129 @@ void HARD_TIMER_RAM_ATTR(testTimingFunctionParams) testTimingFunctionParams(void
 	hardTimerCount += *(uint32_t*)params;
 }
 
+/**
+ * Testing function, appends params digit to count to record order
+ */
+void HARD_TIMER_RAM_ATTR(testOrderFunction) testOrderFunction(void *params) {
+	hardTimerCount = hardTimerCount * 10U + *(uint32_t*)params;
+}
+
+/**
+ * Testing function, stops timer after TEST_STOP_EXPIRIES
+ */
+bool HARD_TIMER_RAM_ATTR(testStoppableFunction) testStoppableFunction(void *params) {
+	hardTimerCount++;
+	return hardTimerCount < TEST_STOP_EXPIRIES;
+}
+
+volatile bool hardTimerPreempted = false;
+
+/**
+ * Testing function, busy waits and checks if count moved meanwhile
+ */
+void HARD_TIMER_RAM_ATTR(testPreemptedFunction) testPreemptedFunction(void *params) {
+	uint32_t before = hardTimerCount;
+	hardTimerDelayUs(TEST_PREEMPT_SPIN_US);
+	if (hardTimerCount != before) {
+		hardTimerPreempted = true;
+	}
+}
+
+volatile bool hardTimerEventValid = true;
+hard_timer_tick_t hardTimerEventDeadline = 0U;
+
+/**
+ * Testing event function, validates expiry information
+ */
+void HARD_TIMER_RAM_ATTR(testEventFunction) testEventFunction(const hard_timer_event_t *event, void *params) {
+	if (event -> sequence != hardTimerCount || event -> timestamp < event -> deadline) {
+		hardTimerEventValid = false;
+	}
+	if (event -> sequence > 0 && event -> deadline - hardTimerEventDeadline != event -> period) {
+		hardTimerEventValid = false;
+	}
+	hardTimerEventDeadline = event -> deadline;
+	hardTimerCount++;
+}
+
+uint32_t hardTimerEventMissed[2] = {0}; // missed periods by sequence
+uint32_t hardTimerEventLate[2] = {0}; // lateness in percent of period by sequence
+
+/**
+ * Testing event function, records missed periods and lateness of first expiries
+ */
+void HARD_TIMER_RAM_ATTR(testMissedFunction) testMissedFunction(const hard_timer_event_t *event, void *params) {
+	if (event -> sequence < 2) {
+		hardTimerEventMissed[event -> sequence] = event -> missed;
+		if (event -> period != 0) {
+			hardTimerEventLate[event -> sequence] = (uint32_t)((event -> timestamp - event -> deadline) * 100U / event -> period);
+		}
+	}
+}
+
+// period statistics gathered from expiry timestamps
+typedef struct {
+	uint64_t first; // timestamp of first expiry
+	uint64_t last; // timestamp of latest expiry
+	uint32_t count; // expiries timestamped
+	uint32_t nominal; // timestamp ticks expected between expiries
+	int64_t deviationSum; // sum of period deviations from nominal
+	uint64_t deviationSquares; // sum of squared period deviations
+	uint32_t deviationMax; // largest period deviation
+} timing_stats_t;
+
+/**
+ * Testing function, adds period since last expiry to statistics
+ * 
+ * @param params pointer to timing_stats_t
+ */
+void HARD_TIMER_RAM_ATTR(testStatsFunction) testStatsFunction(void *params) {
+	timing_stats_t *stats = (timing_stats_t*)params;
+	uint64_t now = hardTimerNow();
+
+	if (stats -> count == 0) {
+		stats -> first = now;
+	}
+	else {
+		int32_t deviation = (int32_t)(uint32_t)(now - stats -> last) - (int32_t)stats -> nominal;
+		uint32_t magnitude = deviation < 0 ? (uint32_t)-deviation : (uint32_t)deviation;
+		stats -> deviationSum += deviation;
+		stats -> deviationSquares += (uint64_t)magnitude * magnitude;
+		if (magnitude > stats -> deviationMax) {
+			stats -> deviationMax = magnitude;
+		}
+	}
+	stats -> last = now;
+	stats -> count++;
+}
+
+/**
+ * Gets integer square root
+ * 
+ * @param value value to get root of
+ * 
+ * @return largest integer whose square is at most value
+ */
+uint32_t squareRoot(uint64_t value) {
+	uint64_t root = 0U;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
 /**
  * Resets all timers to off and unclaimed
  */
@@ -224,8 +429,16 @@ void testClaims(void) {
 		}
 	}
 
-	// claim
+	// lean timers are only set when asked for directly
+	uint8_t claimable = 0;
 	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (!TEST_LEAN_TIMER(i)) {
+			claimable++;
+		}
+	}
+
+	// claim
+	for (uint8_t i = 0; i < claimable; i++) {
 		if (claimTimer(NULL) == HARD_TIMER_INVALID) {
 			TEST_FAIL_MESSAGE(claimLoopFail);
 		}
@@ -236,13 +449,16 @@ void testClaims(void) {
 
 	// all claimed
 	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
-		if (!hardTimerClaimed(i)) {
+		if (hardTimerClaimed(i) == TEST_LEAN_TIMER(i)) {
 			TEST_FAIL_MESSAGE(isClaimedFail);
 		}
 	}
 
 	// remove all claims and test unclaimed
 	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (TEST_LEAN_TIMER(i)) {
+			continue;
+		}
 		if (!unclaimTimer(i)) {
 			TEST_FAIL_MESSAGE(unclaimLoopFail);
 		}
@@ -255,7 +471,7 @@ void testClaims(void) {
 	if (!setHardTimer(&timer, &freq, testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
 		TEST_FAIL_MESSAGE(noStartFail);
 	}
-	for (uint8_t i = 0; i < HARD_TIMER_COUNT - 1; i++) {
+	for (uint8_t i = 0; i < claimable - 1; i++) {
 		if (claimTimer(NULL) == HARD_TIMER_INVALID) {
 			TEST_FAIL_MESSAGE(claimLoopFail);
 		}
@@ -267,6 +483,9 @@ void testClaims(void) {
 	// remove all claims
 	bool claimed = false;
 	for (uint8_t i = 0; i < HARD_TIMER_COUNT; i++) {
+		if (TEST_LEAN_TIMER(i)) {
+			continue;
+		}
 		if (!unclaimTimer(i)) {
 			if (!claimed) {
 				claimed = true;
@@ -424,6 +643,42 @@ void testTimerPriority() {
 	TEST_PASS();
 }
 
+/**
+ * Tests high priority timer runs while low priority callback is busy
+ */
+void testPreemption() {
+	resetTimers();
+
+	#if HARDWARE_TIMER_SUPPORT_AVR && !defined(HARD_TIMER_AVR_NESTED)
+		TEST_IGNORE_MESSAGE(preemptIgnore);
+	#else
+		hard_timer_enum_t slowTimer = HARD_TIMER_INVALID;
+		hard_timer_enum_t fastTimer = HARD_TIMER_INVALID;
+		hard_timer_freq_t freq = TEST_CASES_FREQ;
+
+		hardTimerCount = 0U;
+		hardTimerPreempted = false;
+
+		if (!setHardTimer(&slowTimer, &freq, &testPreemptedFunction, NULL, 0)) {
+			TEST_FAIL_MESSAGE(startFail);
+		}
+		freq = TEST_PREEMPT_FREQ;
+		if (!setHardTimer(&fastTimer, &freq, &testTimingFunction, NULL, UINT8_MAX)) {
+			TEST_FAIL_MESSAGE(startFail);
+		}
+
+		delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+		if (!cancelHardTimer(slowTimer) || !cancelHardTimer(fastTimer)) {
+			TEST_FAIL_MESSAGE(cancelFail);
+		}
+		if (!hardTimerPreempted) {
+			TEST_FAIL_MESSAGE(preemptFail);
+		}
+		TEST_PASS();
+	#endif
+}
+
 /**
  * Tests timing for hardware timer
  * 
@@ -454,6 +709,687 @@ void testTiming(hard_timer_freq_t freq, uint8_t buffer, hard_timer_priority_t pr
 	TEST_PASS();
 }
 
+/**
+ * Tests expiry information given to event callbacks
+ */
+void testEvents() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+
+	hardTimerCount = 0U;
+	hardTimerEventValid = true;
+
+	if (!setHardTimerEvent(&timer, &freq, &testEventFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (hardTimerCount == 0U) {
+		TEST_FAIL_MESSAGE(noEventFail);
+	}
+	if (!hardTimerEventValid) {
+		TEST_FAIL_MESSAGE(eventFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests callback stops its timer by returning false
+ */
+void testSelfStop() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+
+	hardTimerCount = 0U;
+	if (!setHardTimerStoppable(&timer, &freq, &testStoppableFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (hardTimerCount != TEST_STOP_EXPIRIES || hardTimerStarted(timer)) {
+		TEST_FAIL_MESSAGE(selfStopFail);
+	}
+	if (cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(recancelFail);
+	}
+
+	// stopped timer can be set again
+	hard_timer_enum_t again = timer;
+	freq = TEST_CASES_FREQ;
+	if (!setHardTimer(&again, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT) || again != timer) {
+		TEST_FAIL_MESSAGE(restartFail);
+	}
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests polled timer batches expiries between reads
+ */
+void testPolled() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+
+	if (!setHardTimerPolled(&timer, &freq, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if ((getHardTimerReady() & (1UL << timer)) == 0U) {
+		TEST_FAIL_MESSAGE(readyFail);
+	}
+	uint32_t expiries = readHardTimer(timer);
+	TEST_ASSERT_UINT32_WITHIN(freq / 10, freq * TEST_DELAY_ELLAPSE_S, expiries);
+
+	// at most one expiry can land between reads
+	if (readHardTimer(timer) > 1U) {
+		TEST_FAIL_MESSAGE(readFail);
+	}
+	if (readHardTimer(HARD_TIMER_INVALID) != 0U || readHardTimer((hard_timer_enum_t)HARD_TIMER_COUNT) != 0U) {
+		TEST_FAIL_MESSAGE(readFail);
+	}
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (getHardTimerReady() != 0U) {
+		TEST_FAIL_MESSAGE(readyFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests overrun statistics of a timer that keeps up
+ */
+void testOverruns() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_overrun_t overruns;
+
+	if (getHardTimerOverruns(HARD_TIMER_INVALID, &overruns)) {
+		TEST_FAIL_MESSAGE(overrunInvalidFail);
+	}
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (!getHardTimerOverruns(timer, &overruns) || overruns.expiries == 0U) {
+		TEST_FAIL_MESSAGE(overrunStatsFail);
+	}
+	if (overruns.overruns != 0U || overruns.missed != 0U) {
+		TEST_FAIL_MESSAGE(overrunFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests latency histogram is filled for every expiry
+ */
+void testLatency() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_latency_t latency;
+	hard_timer_overrun_t overruns;
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (!getHardTimerLatency(timer, &latency)) {
+		TEST_IGNORE_MESSAGE(latencyIgnore);
+	}
+	getHardTimerOverruns(timer, &overruns);
+
+	uint32_t bucketTotal = 0U;
+	for (uint8_t i = 0; i < HARD_TIMER_LATENCY_BUCKETS; i++) {
+		bucketTotal += latency.buckets[i];
+	}
+	if (latency.count != overruns.expiries || bucketTotal != latency.count) {
+		TEST_FAIL_MESSAGE(latencyFail);
+	}
+	if (latency.min > latency.mean || latency.mean > latency.max) {
+		TEST_FAIL_MESSAGE(latencyFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests callback profile is filled for every expiry
+ */
+void testProfile() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_profile_t profile;
+	hard_timer_overrun_t overruns;
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	uint8_t load = getHardTimerLoad(timer);
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (!getHardTimerProfile(timer, &profile)) {
+		TEST_IGNORE_MESSAGE(profileIgnore);
+	}
+	getHardTimerOverruns(timer, &overruns);
+
+	if (profile.count != overruns.expiries || profile.count == 0) {
+		TEST_FAIL_MESSAGE(profileFail);
+	}
+	if (profile.last > profile.max || profile.average > profile.max || profile.total < profile.max) {
+		TEST_FAIL_MESSAGE(profileFail);
+	}
+	if (load > 100U) {
+		TEST_FAIL_MESSAGE(profileFail);
+	}
+	TEST_PASS();
+}
+
+#if HARDWARE_TIMER_SUPPORT_AVR
+
+/**
+ * Tests toggle mode reaches exact and maximum pin frequencies
+ */
+void testToggle() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = HARD_TIMER_TOGGLE_FREQ_MAX;
+
+	if (!setHardTimerToggle(&timer, &freq)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	if (freq != HARD_TIMER_TOGGLE_FREQ_MAX || !hardTimerStarted(timer)) {
+		TEST_FAIL_MESSAGE(toggleFail);
+	}
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+
+	freq = TEST_CASES_FREQ;
+	if (!setHardTimerToggle(&timer, &freq)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	if (freq != TEST_CASES_FREQ) {
+		TEST_FAIL_MESSAGE(toggleFail);
+	}
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	TEST_PASS();
+}
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Tests compare B timer expires once per divider compare A expiries
+ */
+void testCompareB() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_freq_t channelFreq = TEST_CASES_FREQ / 4;
+	hard_timer_overrun_t overruns;
+	hard_timer_overrun_t channelOverruns;
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	hard_timer_enum_t channel = HARD_TIMER_COMPARE_B(timer);
+	if (!setHardTimerPhase(channel, 1)) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+	if (!setHardTimer(&channel, &channelFreq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	if (channelFreq != TEST_CASES_FREQ / 4 || channel != HARD_TIMER_COMPARE_B(timer)) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer) || !cancelHardTimer(channel)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	getHardTimerOverruns(timer, &overruns);
+	getHardTimerOverruns(channel, &channelOverruns);
+
+	// compare A kept counting for compare B, so both stop within a period
+	TEST_ASSERT_UINT32_WITHIN(4, overruns.expiries, channelOverruns.expiries * 4);
+
+	// compare B can't run without compare A
+	channelFreq = TEST_CASES_FREQ;
+	if (setHardTimer(&channel, &channelFreq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests compare B keeps expiring when compare A period shrinks under its target
+ */
+void testCompareBPeriod() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_freq_t channelFreq = TEST_CASES_FREQ / 4;
+	hard_timer_overrun_t overruns;
+	hard_timer_overrun_t channelOverruns;
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	hard_timer_tick_t period = hardTimerInfo[timer].period;
+	hard_timer_enum_t channel = HARD_TIMER_COMPARE_B(timer);
+	if (!setHardTimerPhase(channel, period - 1)) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+	if (!setHardTimer(&channel, &channelFreq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	// as trims and slack do while compare B runs
+	setHardTimerPeriod(timer, period / 2);
+	if (hardTimerInfo[channel].period != period / 2 * 4) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer) || !cancelHardTimer(channel)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	getHardTimerOverruns(timer, &overruns);
+	getHardTimerOverruns(channel, &channelOverruns);
+	if (channelOverruns.expiries == 0) {
+		TEST_FAIL_MESSAGE(compareBFail);
+	}
+	TEST_ASSERT_UINT32_WITHIN(4, overruns.expiries, channelOverruns.expiries * 4);
+	TEST_PASS();
+}
+
+#endif
+
+#endif
+
+/**
+ * Tests references are accepted only while timer runs and trims stay limited
+ */
+void testDiscipline() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_discipline_t discipline;
+
+	if (!getHardTimerDiscipline(HARD_TIMER0, &discipline)) {
+		TEST_IGNORE_MESSAGE(disciplineIgnore);
+	}
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	// reference claims timer clock runs 1% slow
+	uint64_t reference = 1000000ULL;
+	for (uint8_t i = 0; i < 3; i++) {
+		if (!disciplineHardTimer(timer, reference)) {
+			TEST_FAIL_MESSAGE(disciplineFail);
+		}
+		delaySeconds(TEST_DELAY_ELLAPSE_S);
+		reference += TEST_DELAY_ELLAPSE_S * 1010000ULL;
+	}
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	if (disciplineHardTimer(timer, reference)) {
+		TEST_FAIL_MESSAGE(disciplineFail);
+	}
+	getHardTimerDiscipline(timer, &discipline);
+	if (discipline.references != 3 || discipline.offsetPpb >= 0) {
+		TEST_FAIL_MESSAGE(disciplineFail);
+	}
+	if (discipline.trimPpb > 500000L || discipline.trimPpb < -500000L) {
+		TEST_FAIL_MESSAGE(disciplineFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests timer with slack shares wakeups without losing expiries
+ */
+void testSlack() {
+	resetTimers();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_enum_t slackTimer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_CASES_FREQ;
+	hard_timer_freq_t slackFreq = TEST_CASES_FREQ;
+	hard_timer_overrun_t overruns;
+	hard_timer_slack_t slack;
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	if (!setHardTimer(&slackTimer, &slackFreq, &testTimingFunction, NULL, 0)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	if (!setHardTimerTolerance(slackTimer, 500000UL / TEST_CASES_FREQ)) {
+		cancelHardTimer(timer);
+		cancelHardTimer(slackTimer);
+		TEST_IGNORE_MESSAGE(slackIgnore);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(slackTimer) || !cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+	setHardTimerTolerance(slackTimer, 0);
+
+	if (!getHardTimerSlack(slackTimer, &slack) || slack.shared == 0U || slack.savedMilliHz == 0U) {
+		TEST_FAIL_MESSAGE(slackFail);
+	}
+	getHardTimerOverruns(slackTimer, &overruns);
+	if (slack.shared > overruns.expiries || slack.shifted > slack.shared) {
+		TEST_FAIL_MESSAGE(slackFail);
+	}
+
+	// moved expiries come early, not extra
+	TEST_ASSERT_UINT32_WITHIN(slackFreq / 10, slackFreq * TEST_DELAY_ELLAPSE_S, overruns.expiries);
+	TEST_PASS();
+}
+
+/**
+ * Tests trace records fires in order and ends with cancel
+ */
+void testTrace() {
+	resetTimers();
+	clearHardTimerTrace();
+	hard_timer_enum_t timer = HARD_TIMER_INVALID;
+	hard_timer_freq_t freq = TEST_SLOW_FREQ;
+	static hard_timer_trace_record_t records[HARD_TIMER_TRACE_SIZE];
+
+	if (!setHardTimer(&timer, &freq, &testTimingFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+
+	delaySeconds(TEST_DELAY_ELLAPSE_S);
+
+	if (!cancelHardTimer(timer)) {
+		TEST_FAIL_MESSAGE(cancelFail);
+	}
+
+	uint16_t count = getHardTimerTrace(records, HARD_TIMER_TRACE_SIZE, NULL);
+	if (count == 0) {
+		TEST_IGNORE_MESSAGE(traceIgnore);
+	}
+
+	uint16_t fires = 0;
+	uint16_t sequence = 0;
+	hard_timer_trace_record_t *last = NULL;
+	for (uint16_t i = 0; i < count; i++) {
+		if (records[i].timer != timer) {
+			continue;
+		}
+		if (records[i].event == HARD_TIMER_TRACE_FIRE) {
+			if (fires != 0 && records[i].data != (uint16_t)(sequence + 1)) {
+				TEST_FAIL_MESSAGE(traceFail);
+			}
+			sequence = records[i].data;
+			fires++;
+		}
+		last = &records[i];
+	}
+	if (fires == 0 || last == NULL || last -> event != HARD_TIMER_TRACE_CANCEL) {
+		TEST_FAIL_MESSAGE(traceFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests replay runs fire records in order and paced by speedup
+ */
+void testReplay() {
+	resetTimers();
+	hard_timer_claim_s claim = {0};
+	static uint32_t digits[2] = {1U, 2U};
+
+	hard_timer_enum_t first = claimTimer(&claim);
+	hard_timer_enum_t second = claimTimer(&claim);
+	if (first == HARD_TIMER_INVALID || second == HARD_TIMER_INVALID) {
+		TEST_FAIL_MESSAGE(allClaimedFail);
+	}
+	setHardTimerFunction(first, &testOrderFunction, &digits[0]);
+	setHardTimerFunction(second, &testOrderFunction, &digits[1]);
+
+	// timestamps in milliseconds, only fires of valid timers run
+	hard_timer_trace_record_t records[] = {
+		{0U, first, HARD_TIMER_TRACE_FIRE, 0},
+		{5U, second, HARD_TIMER_TRACE_SET, 0},
+		{10U, second, HARD_TIMER_TRACE_FIRE, 0},
+		{20U, first, HARD_TIMER_TRACE_FIRE, 1},
+		{25U, HARD_TIMER_INVALID, HARD_TIMER_TRACE_FIRE, 0},
+		{TEST_REPLAY_MS, second, HARD_TIMER_TRACE_FIRE, 1},
+	};
+	uint16_t count = sizeof(records) / sizeof(records[0]);
+
+	hardTimerCount = 0U;
+	if (replayHardTimerTrace(records, count, 1000, 0) != 4 || hardTimerCount != 1212U) {
+		TEST_FAIL_MESSAGE(replayFail);
+	}
+
+	if (HARD_TIMER_NOW_FREQ != 0) {
+		uint64_t start = hardTimerNow();
+		replayHardTimerTrace(records, count, 1000, TEST_REPLAY_SPEEDUP);
+		uint32_t elapsedUs = (uint32_t)(hardTimerToNs(hardTimerNow() - start) / 1000ULL);
+		TEST_ASSERT_UINT32_WITHIN(DELAY_TEST_BUFFER_US * 10, TEST_REPLAY_MS * 1000 / TEST_REPLAY_SPEEDUP, elapsedUs);
+	}
+
+	// late fire has its overrun recorded after it, past fires of other timers
+	setHardTimerEventFunction(first, &testMissedFunction, NULL);
+	hard_timer_trace_record_t late[] = {
+		{0U, first, HARD_TIMER_TRACE_FIRE, 0},
+		{1U, second, HARD_TIMER_TRACE_FIRE, 2},
+		{2U, first, HARD_TIMER_TRACE_OVERRUN, 3},
+		{3U, first, HARD_TIMER_TRACE_FIRE, 1},
+	};
+	hardTimerEventMissed[0] = 0U;
+	hardTimerEventMissed[1] = 1U;
+	replayHardTimerTrace(late, sizeof(late) / sizeof(late[0]), 1000, 0);
+	if (hardTimerEventMissed[0] != 3U || hardTimerEventMissed[1] != 0U) {
+		TEST_FAIL_MESSAGE(replayFail);
+	}
+
+	// lateness comes from recorded timestamps in ticks of the timer
+	hard_timer_freq_t freq = TEST_REPLAY_FREQ;
+	if (!setHardTimerEvent(&first, &freq, &testMissedFunction, NULL, HARD_TIMER_PRIORITY_DEFAULT) || !cancelHardTimer(first)) {
+		TEST_FAIL_MESSAGE(startFail);
+	}
+	uint32_t periodMs = 1000U / TEST_REPLAY_FREQ;
+	hard_timer_trace_record_t timed[] = {
+		{0U, first, HARD_TIMER_TRACE_FIRE, 0},
+		{periodMs + periodMs * TEST_REPLAY_LATE / 100U, first, HARD_TIMER_TRACE_FIRE, 1},
+	};
+	hardTimerEventLate[0] = UINT32_MAX;
+	hardTimerEventLate[1] = 0U;
+	replayHardTimerTrace(timed, sizeof(timed) / sizeof(timed[0]), 1000, 0);
+	if (hardTimerEventLate[0] != 0U) {
+		TEST_FAIL_MESSAGE(replayFail);
+	}
+	TEST_ASSERT_UINT32_WITHIN(1, TEST_REPLAY_LATE, hardTimerEventLate[1]);
+
+	// sequences carry on past 16 bits instead of starting over
+	hard_timer_trace_record_t wrapped[] = {
+		{0U, first, HARD_TIMER_TRACE_FIRE, UINT16_MAX},
+		{periodMs, first, HARD_TIMER_TRACE_FIRE, 0},
+		{periodMs * 2U, first, HARD_TIMER_TRACE_FIRE, 1},
+	};
+	hardTimerEventMissed[0] = UINT32_MAX;
+	hardTimerEventMissed[1] = UINT32_MAX;
+	replayHardTimerTrace(wrapped, sizeof(wrapped) / sizeof(wrapped[0]), 1000, 0);
+	if (hardTimerEventMissed[0] != UINT32_MAX || hardTimerEventMissed[1] != UINT32_MAX) {
+		TEST_FAIL_MESSAGE(replayFail);
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests busy wait against free running clock
+ */
+void testDelay() {
+	resetTimers();
+
+	#if HARD_TIMER_CLOCK_FREQ == 0
+		TEST_IGNORE_MESSAGE(delayIgnore);
+	#else
+		// warms caches before timing
+		hardTimerDelayUs(TEST_DELAY_US);
+
+		uint32_t start = HARD_TIMER_CLOCK();
+		hardTimerDelayUs(TEST_DELAY_US);
+		uint32_t elapsed = HARD_TIMER_CLOCK() - start;
+
+		uint32_t elapsedUs = (uint32_t)((uint64_t)elapsed * 1000000ULL / HARD_TIMER_CLOCK_FREQ);
+		TEST_ASSERT_UINT32_WITHIN(DELAY_TEST_BUFFER_US, TEST_DELAY_US, elapsedUs);
+		TEST_PASS();
+	#endif
+}
+
+/**
+ * Tests timestamps only move forward and convert to elapsed nanoseconds
+ */
+void testNow() {
+	resetTimers();
+
+	if (HARD_TIMER_NOW_FREQ == 0) {
+		TEST_IGNORE_MESSAGE(nowIgnore);
+	}
+
+	uint64_t last = hardTimerNow();
+	for (uint16_t i = 0; i < 1000; i++) {
+		uint64_t now = hardTimerNow();
+		if (now < last) {
+			TEST_FAIL_MESSAGE(nowFail);
+		}
+		last = now;
+	}
+
+	uint64_t start = hardTimerNow();
+	hardTimerDelayUs(TEST_DELAY_US);
+	uint32_t elapsedUs = (uint32_t)(hardTimerToNs(hardTimerNow() - start) / 1000ULL);
+	TEST_ASSERT_UINT32_WITHIN(DELAY_TEST_BUFFER_US, TEST_DELAY_US, elapsedUs);
+	TEST_PASS();
+}
+
+/**
+ * Tests period jitter, deviation and drift over every swept frequency
+ */
+void testTimingStats() {
+	resetTimers();
+
+	if (HARD_TIMER_NOW_FREQ == 0) {
+		TEST_IGNORE_MESSAGE(nowIgnore);
+	}
+
+	const hard_timer_freq_t sweep[] = STATS_TEST_FREQS;
+	static timing_stats_t stats;
+
+	for (uint8_t i = 0; i < sizeof(sweep) / sizeof(hard_timer_freq_t); i++) {
+		hard_timer_enum_t timer = HARD_TIMER_INVALID;
+		hard_timer_freq_t freq = sweep[i];
+
+		memset(&stats, 0, sizeof(stats));
+		stats.nominal = (uint32_t)(HARD_TIMER_NOW_FREQ / freq);
+
+		if (!setHardTimer(&timer, &freq, &testStatsFunction, (void*)&stats, HARD_TIMER_PRIORITY_DEFAULT)) {
+			TEST_FAIL_MESSAGE(startFail);
+		}
+		// achieved frequency may differ from swept one
+		stats.nominal = (uint32_t)(HARD_TIMER_NOW_FREQ / freq);
+
+		hardTimerDelayUs(STATS_TEST_WINDOW_MS * 1000UL);
+
+		if (!cancelHardTimer(timer)) {
+			TEST_FAIL_MESSAGE(cancelFail);
+		}
+		if (stats.count <= STATS_TEST_MIN_PERIODS) {
+			TEST_FAIL_MESSAGE(statsCountFail);
+		}
+
+		uint32_t periods = stats.count - 1;
+		int64_t mean = stats.deviationSum / (int64_t)periods;
+		uint64_t meanSquare = stats.deviationSquares / periods;
+		uint64_t variance = 0U;
+		if (meanSquare > (uint64_t)(mean * mean)) {
+			variance = meanSquare - (uint64_t)(mean * mean);
+		}
+		if (hardTimerToNs(squareRoot(variance)) > STATS_TEST_JITTER_NS) {
+			TEST_FAIL_MESSAGE(jitterFail);
+		}
+		if (hardTimerToNs(stats.deviationMax) > STATS_TEST_DEVIATION_NS) {
+			TEST_FAIL_MESSAGE(deviationFail);
+		}
+
+		uint64_t expected = (uint64_t)periods * HARD_TIMER_NOW_FREQ / freq;
+		int64_t drift = (int64_t)(stats.last - stats.first) - (int64_t)expected;
+		int64_t driftPpm = drift * 1000000LL / (int64_t)expected;
+		if (driftPpm > STATS_TEST_DRIFT_PPM || driftPpm < -STATS_TEST_DRIFT_PPM) {
+			TEST_FAIL_MESSAGE(driftFail);
+		}
+	}
+	TEST_PASS();
+}
+
+/**
+ * Tests random claim, set and cancel sequences against state model
+ */
+void testStateMachine() {
+	resetTimers();
+	static uint8_t data[FUZZ_TEST_BYTES];
+	uint32_t seed = FUZZ_TEST_SEED;
+
+	for (uint16_t i = 0; i < FUZZ_TEST_SEQUENCES; i++) {
+		for (uint8_t j = 0; j < FUZZ_TEST_BYTES; j++) {
+			// xorshift keeps sequences repeatable across platforms
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			data[j] = (uint8_t)seed;
+		}
+		if (!fuzzHardTimerStates(data, FUZZ_TEST_BYTES)) {
+			TEST_FAIL_MESSAGE(stateMachineFail);
+		}
+	}
+	TEST_PASS();
+}
+
 /**
  * Tests slow timing accuracy
  */
@@ -474,6 +1410,28 @@ void testTimers() {
 	RUN_TEST(&testClaims);
 	RUN_TEST(&testStart);
 	RUN_TEST(&testTimerPriority);
+	RUN_TEST(&testPreemption);
+	RUN_TEST(&testStateMachine);
+	RUN_TEST(&testEvents);
+	RUN_TEST(&testSelfStop);
+	RUN_TEST(&testPolled);
+	RUN_TEST(&testOverruns);
+	RUN_TEST(&testLatency);
+	RUN_TEST(&testProfile);
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		RUN_TEST(&testToggle);
+		#ifdef HARD_TIMER_AVR_COMPARE_B
+			RUN_TEST(&testCompareB);
+			RUN_TEST(&testCompareBPeriod);
+		#endif
+	#endif
+	RUN_TEST(&testDiscipline);
+	RUN_TEST(&testSlack);
+	RUN_TEST(&testTrace);
+	RUN_TEST(&testReplay);
+	RUN_TEST(&testDelay);
+	RUN_TEST(&testNow);
+	RUN_TEST(&testTimingStats);
 	RUN_TEST(&testSlowTiming);
 	RUN_TEST(&testFastTiming);
 	resetTimers();
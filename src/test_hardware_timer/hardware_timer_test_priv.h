@@ -30,6 +30,13 @@ typedef const char memCharString;
 	#define PROG_FLASH // storage specifier for flash space
 #endif
 
+#if HARDWARE_TIMER_SUPPORT_AVR && defined(HARD_TIMER_AVR_LEAN)
+	// timer has its ISR outside of library, so it is never claimed or picked
+	#define TEST_LEAN_TIMER(timer) ((timer) < HARD_TIMER_HARDWARE_COUNT && ((HARD_TIMER_AVR_LEAN >> (timer)) & 1))
+#else
+	#define TEST_LEAN_TIMER(timer) false // every timer can be claimed
+#endif
+
 // use Unity
 #if defined(PIO_UNIT_TESTING) || defined(ESP_IDF_UNIT_TESTING) || defined(PICO_SDK_UNIT_TESTING)
 	#include <unity.h>
@@ -87,6 +94,16 @@ typedef const char memCharString;
 	#define TEST_ASSERT_UINT32_WITHIN(buffer, targetCount, realCount) if (!timerCountWithin(buffer, targetCount, realCount, __LINE__)) {return;}
 #endif
 
+// result of one benchmark
+typedef struct {
+	uint16_t repetitions; // times benchmark was repeated
+	uint32_t ops; // operations per repetition
+	uint32_t minCycles; // fastest repetition in CPU cycles per operation
+	uint32_t meanCycles; // average repetition in CPU cycles per operation
+	uint32_t maxCycles; // slowest repetition in CPU cycles per operation
+	uint32_t meanNs; // average repetition in nanoseconds per operation
+} hard_timer_bench_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -98,6 +115,27 @@ extern "C" {
  */
 void delaySeconds(uint8_t seconds);
 
+/**
+ * Prints benchmark result as a CSV row
+ * 
+ * @param name name of benchmark, or NULL to print CSV header
+ * @param result result to print, or NULL to print CSV header
+ */
+void printBenchmarkResult(const char *name, const hard_timer_bench_t *result);
+
+/**
+ * Runs operations decoded from bytes and checks claim and start
+ * states against a model of setHardTimer's documented table
+ * 
+ * @param data two bytes per operation, operation then timer
+ * @param size bytes of data
+ * 
+ * @return if every operation matched model
+ * 
+ * @note stops and unclaims every timer before and after
+ */
+bool fuzzHardTimerStates(const uint8_t *data, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -89,4 +89,37 @@ void runTest(const char* funcName, const int funcLine) {
 	}
 }
 
+#endif
+
+#if !defined(ARDUINO) && defined(HARD_TIMER_TRACE)
+
+// copy of trace records being printed
+static hard_timer_trace_record_t traceDump[HARD_TIMER_TRACE_SIZE];
+
+void dumpHardTimerTrace() {
+	hard_timer_freq_t clockFreq = 0;
+	uint16_t count = getHardTimerTrace(traceDump, HARD_TIMER_TRACE_SIZE, &clockFreq);
+
+	printf("hard_timer_trace %lu %u\n", (unsigned long)clockFreq, count);
+	for (uint16_t i = 0; i < count; i++) {
+		printf("%08lx%02x%02x%04x\n", (unsigned long)traceDump[i].timestamp,
+			(uint8_t)traceDump[i].timer, traceDump[i].event, traceDump[i].data);
+	}
+	printf("hard_timer_trace_end\n");
+}
+
+#endif
+
+#if !defined(ARDUINO)
+
+void printBenchmarkResult(const char *name, const hard_timer_bench_t *result) {
+	if (name == NULL || result == NULL) {
+		printf("benchmark,repetitions,ops,cycles_min,cycles_mean,cycles_max,ns_mean\n");
+		return;
+	}
+	printf("%s,%u,%lu,%lu,%lu,%lu,%lu\n", name, result -> repetitions, (unsigned long)result -> ops,
+		(unsigned long)result -> minCycles, (unsigned long)result -> meanCycles,
+		(unsigned long)result -> maxCycles, (unsigned long)result -> meanNs);
+}
+
 #endif
\ No newline at end of file
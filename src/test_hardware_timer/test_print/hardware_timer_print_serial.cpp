@@ -79,4 +79,56 @@ void runTest(const char* funcName, const int funcLine) {
 	}
 }
 
+#endif
+
+#if defined(ARDUINO) && defined(HARD_TIMER_TRACE)
+
+#include <Arduino.h>
+
+// copy of trace records being printed
+static hard_timer_trace_record_t traceDump[HARD_TIMER_TRACE_SIZE];
+
+void dumpHardTimerTrace() {
+	hard_timer_freq_t clockFreq = 0;
+	uint16_t count = getHardTimerTrace(traceDump, HARD_TIMER_TRACE_SIZE, &clockFreq);
+	char line[17];
+
+	Serial.print(F("hard_timer_trace "));
+	Serial.print(clockFreq);
+	Serial.print(F(" "));
+	Serial.println(count);
+	for (uint16_t i = 0; i < count; i++) {
+		sprintf(line, "%08lx%02x%02x%04x", (unsigned long)traceDump[i].timestamp,
+			(uint8_t)traceDump[i].timer, traceDump[i].event, traceDump[i].data);
+		Serial.println(line);
+	}
+	Serial.println(F("hard_timer_trace_end"));
+}
+
+#endif
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+
+void printBenchmarkResult(const char *name, const hard_timer_bench_t *result) {
+	if (name == NULL || result == NULL) {
+		Serial.println(F("benchmark,repetitions,ops,cycles_min,cycles_mean,cycles_max,ns_mean"));
+		return;
+	}
+	Serial.print(name);
+	Serial.print(F(","));
+	Serial.print(result -> repetitions);
+	Serial.print(F(","));
+	Serial.print(result -> ops);
+	Serial.print(F(","));
+	Serial.print(result -> minCycles);
+	Serial.print(F(","));
+	Serial.print(result -> meanCycles);
+	Serial.print(F(","));
+	Serial.print(result -> maxCycles);
+	Serial.print(F(","));
+	Serial.println(result -> meanNs);
+}
+
 #endif
\ No newline at end of file
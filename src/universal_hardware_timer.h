@@ -92,10 +92,16 @@ typedef void (*hard_timer_function_ptr_t) (void*); // timer callback function po
 	****************************/
 
 	#include <esp_idf_version.h>
+	#include <esp_attr.h>
 
 	#define HARD_TIMER_FREQ_MAX 200000 // max frequency user set timer can be
 	#define HARD_TIMER_COUNT 4 // amount of hardware timers to use
 
+	typedef uint64_t hard_timer_tick_t; // timer tick count type
+
+	#define HARD_TIMER_RAM_ATTR(funcName) IRAM_ATTR // places function in IRAM
+	#define HARD_TIMER_DATA_ATTR DRAM_ATTR // places variable in DRAM
+
 	#if ESP_IDF_VERSION_MAJOR == 4
 		#include <driver/timer.h>
 		typedef timer_isr_t hard_timer_callback_ptr_t; // callback pointer type
@@ -125,6 +131,11 @@ typedef void (*hard_timer_function_ptr_t) (void*); // timer callback function po
 	#include <pico/time.h>
 	typedef repeating_timer_callback_t hard_timer_callback_ptr_t; // callback pointer type
 
+	typedef uint64_t hard_timer_tick_t; // timer tick count type
+
+	#define HARD_TIMER_RAM_ATTR(funcName) __not_in_flash(#funcName) // places function in SRAM
+	#define HARD_TIMER_DATA_ATTR // variables are always in SRAM
+
 #elif HARDWARE_TIMER_SUPPORT_AVR
 
 	/****************************
@@ -139,19 +150,31 @@ typedef void (*hard_timer_function_ptr_t) (void*); // timer callback function po
 
 	#if F_CPU == 16000000L
 		#define HARD_TIMER_FREQ_MAX 120000 // max frequency user set timer can be
+		#define HARD_TIMER_TOGGLE_FREQ_MAX 8000000 // max frequency of toggled pin
 	#else
 		#error "F_CPU must be (MHz) 16"
 	#endif
 
 	#ifdef OVERRIDE_ARDUINO_TIMER
-		#define HARD_TIMER_COUNT 3 // amount of hardware timers to use
+		#define HARD_TIMER_HARDWARE_COUNT 3 // amount of hardware timers to use
 	#else
-		#define HARD_TIMER_COUNT 2 // amount of hardware timers to use
+		#define HARD_TIMER_HARDWARE_COUNT 2 // amount of hardware timers to use
+	#endif
+
+	#ifdef HARD_TIMER_AVR_COMPARE_B
+		#define HARD_TIMER_COUNT (HARD_TIMER_HARDWARE_COUNT * 2) // compare B adds a timer per hardware timer
+	#else
+		#define HARD_TIMER_COUNT HARD_TIMER_HARDWARE_COUNT // amount of timers to use
 	#endif
 
 	typedef void* hard_timer_callback_ptr_t; // callback pointer type
 	#define NO_TIMER_CALLBACK_SUPPORT // hardware timer doesn't use callbacks
 
+	typedef uint32_t hard_timer_tick_t; // timer tick count type
+
+	#define HARD_TIMER_RAM_ATTR(funcName) // code always runs from flash
+	#define HARD_TIMER_DATA_ATTR // variables are always in SRAM
+
 #else
 
 	/****************************
@@ -166,6 +189,11 @@ typedef void (*hard_timer_function_ptr_t) (void*); // timer callback function po
 		#define HARD_TIMER_COUNT 0 // amount of hardware timers to use
 	#endif
 
+	typedef uint32_t hard_timer_tick_t; // timer tick count type
+
+	#define HARD_TIMER_RAM_ATTR(funcName) // no RAM placement available
+	#define HARD_TIMER_DATA_ATTR // no RAM placement available
+
 #endif
 
 typedef enum { // hardware timer enum type
@@ -220,6 +248,106 @@ typedef enum { // hardware timer enum type
 	#endif
 } hard_timer_enum_t;
 
+/**
+ * Expiry information passed to event callbacks
+ * 
+ * @note ticks are in the resolution of the timer's counter
+ * @note and count from when the timer was set
+ */
+typedef struct {
+	hard_timer_tick_t timestamp; // ticks when callback was entered
+	hard_timer_tick_t deadline; // ticks expiry was scheduled for
+	hard_timer_tick_t period; // ticks between expiries
+	uint32_t sequence; // expiries before this one since timer was set
+	uint32_t missed; // whole periods callback is late by, 0 on ESP32 and AVR without HARD_TIMER_COUNT_MISSED
+} hard_timer_event_t;
+
+typedef void (*hard_timer_event_function_ptr_t) (const hard_timer_event_t*, void*); // timer event callback function pointer
+typedef bool (*hard_timer_stoppable_function_ptr_t) (void*); // timer callback function pointer returning if timer keeps running
+
+// overrun statistics of a timer
+typedef struct {
+	uint32_t expiries; // expiries since timer was set
+	uint32_t overruns; // expiries that ran late or past their period
+	uint32_t missed; // whole periods missed by late expiries
+} hard_timer_overrun_t;
+
+typedef void (*hard_timer_overrun_ptr_t) (hard_timer_enum_t, uint32_t); // overrun hook function pointer
+
+#ifndef HARD_TIMER_LATENCY_BUCKETS
+	#define HARD_TIMER_LATENCY_BUCKETS 16 // log2 buckets in latency histogram
+#endif
+
+/**
+ * ISR latency histogram of a timer
+ * 
+ * @note bucket 0 counts latencies of 0, bucket i counts latencies
+ * @note from 2^(i-1) to 2^i - 1 and the last bucket counts the rest
+ */
+typedef struct {
+	uint32_t buckets[HARD_TIMER_LATENCY_BUCKETS]; // log2 latency buckets
+	uint32_t count; // latencies recorded
+	uint32_t min; // shortest latency
+	uint32_t max; // longest latency
+	uint32_t mean; // average latency
+	uint64_t total; // sum of latencies
+	hard_timer_freq_t clockFreq; // latency clock cycles per second
+} hard_timer_latency_t;
+
+// execution time profile of a timer callback
+typedef struct {
+	uint32_t last; // duration of last callback
+	uint32_t max; // longest callback
+	uint32_t average; // exponential moving average of callbacks
+	uint32_t count; // callbacks profiled
+	uint64_t total; // sum of callback durations
+	hard_timer_freq_t clockFreq; // profile clock cycles per second
+} hard_timer_profile_t;
+
+// reference clock discipline state of a timer
+typedef struct {
+	int32_t offsetPpb; // estimated frequency error of timer clock in parts per billion
+	int32_t trimPpb; // correction applied to period in parts per billion
+	int32_t phaseUs; // microseconds timer was ahead of reference at last reference
+	uint32_t references; // reference timestamps fed since timer was set
+} hard_timer_discipline_t;
+
+// expiry coalescing state of a timer
+typedef struct {
+	uint32_t toleranceUs; // microseconds expiries may move from schedule to share a wakeup
+	uint32_t shifted; // expiries moved onto another timer's expiry
+	uint32_t shared; // expiries that shared a wakeup with another timer
+	uint32_t savedMilliHz; // wakeups saved per second since timer was set, in thousandths
+} hard_timer_slack_t;
+
+typedef enum {
+	HARD_TIMER_TRACE_NONE, // unused trace record
+	HARD_TIMER_TRACE_SET, // timer was set
+	HARD_TIMER_TRACE_CANCEL, // timer was cancelled
+	HARD_TIMER_TRACE_FIRE, // timer callback ran
+	HARD_TIMER_TRACE_OVERRUN, // timer overran its period
+} hard_timer_trace_event_t;
+
+// binary trace record of a timer event
+typedef struct {
+	uint32_t timestamp; // trace clock cycles when event happened
+	int8_t timer; // hard_timer_enum_t of event
+	uint8_t event; // hard_timer_trace_event_t of event
+	uint16_t data; // expiry sequence for fires, missed periods for overruns
+} hard_timer_trace_record_t;
+
+#ifndef HARD_TIMER_TRACE_SIZE
+	#if HARDWARE_TIMER_SUPPORT_AVR
+		#define HARD_TIMER_TRACE_SIZE 32 // records in trace ring buffer
+	#else
+		#define HARD_TIMER_TRACE_SIZE 256 // records in trace ring buffer
+	#endif
+#endif
+
+#if (HARD_TIMER_TRACE_SIZE & (HARD_TIMER_TRACE_SIZE - 1)) != 0
+	#error "HARD_TIMER_TRACE_SIZE must be a power of 2"
+#endif
+
 /****************************
  * Library functions
 ****************************/
@@ -289,6 +417,9 @@ bool cancelHardTimer(hard_timer_enum_t timer);
  * 
  * Not Started:  HARD_TIMER#,  HARD_TIMER#
  * 
+ * @note with HARD_TIMER_AVR_COMPARE_B, a compare A timer whose compare B
+ * runs counts as started, so it can't be claimed and fails if already claimed
+ * 
  * @return if timer was successfully set
  */
 bool setHardTimer(hard_timer_enum_t *timer, hard_timer_freq_t *freq,
@@ -315,6 +446,465 @@ bool hardTimerStarted(hard_timer_enum_t timer);
 bool setHardTimerFunction(hard_timer_enum_t timer,
 		hard_timer_function_ptr_t function, void* params);
 
+/**
+ * Starts hardware timer execution with an event callback
+ * 
+ * @param timer pointer to timer to start
+ * @param freq pointer to desired frequency in Hz
+ * @param function pointer to event function to call back
+ * @param params parameters to pass to callback function
+ * @param priority priority to run timer at (0 min, 255 max)
+ * 
+ * @note follows the same rules as setHardTimer
+ * 
+ * @return if timer was successfully set
+ */
+bool setHardTimerEvent(hard_timer_enum_t *timer, hard_timer_freq_t *freq,
+		hard_timer_event_function_ptr_t function, void* params,
+		hard_timer_priority_t priority);
+
+/**
+ * Sets event function to execute for timer ISR
+ * 
+ * @param timer timer to set
+ * @param function event function to set
+ * @param params parameters to pass to callback function
+ * 
+ * @return if successfully set
+ */
+bool setHardTimerEventFunction(hard_timer_enum_t timer,
+		hard_timer_event_function_ptr_t function, void* params);
+
+/**
+ * Starts hardware timer execution with a callback that can stop it
+ * 
+ * Timer stops from its ISR as soon as callback returns false, without
+ * calling cancelHardTimer from interrupt context
+ * 
+ * @param timer pointer to timer to start
+ * @param freq pointer to desired frequency in Hz
+ * @param function pointer to function to call back, returns if timer keeps running
+ * @param params parameters to pass to callback function
+ * @param priority priority to run timer at (0 min, 255 max)
+ * 
+ * @note follows the same rules as setHardTimer
+ * @note stopped timers keep their claim
+ * 
+ * @return if timer was successfully set
+ */
+bool setHardTimerStoppable(hard_timer_enum_t *timer, hard_timer_freq_t *freq,
+		hard_timer_stoppable_function_ptr_t function, void* params,
+		hard_timer_priority_t priority);
+
+/**
+ * Sets function that can stop timer to execute for timer ISR
+ * 
+ * @param timer timer to set
+ * @param function function to set, returns if timer keeps running
+ * @param params parameters to pass to callback function
+ * 
+ * @return if successfully set
+ */
+bool setHardTimerStoppableFunction(hard_timer_enum_t timer,
+		hard_timer_stoppable_function_ptr_t function, void* params);
+
+/**
+ * Gets overrun statistics of timer
+ * 
+ * An overrun is an expiry that happens while the previous
+ * callback is still running, a callback that runs past the
+ * next expiry, or an interrupt delayed past the next period
+ * 
+ * @param timer timer to get
+ * @param overruns pointer to store statistics in
+ * 
+ * @note statistics reset when timer is set
+ * 
+ * @return if statistics were retrieved
+ */
+bool getHardTimerOverruns(hard_timer_enum_t timer, hard_timer_overrun_t *overruns);
+
+/**
+ * Starts hardware timer that only counts expiries for polling
+ * 
+ * @param timer pointer to timer to start
+ * @param freq pointer to desired frequency in Hz
+ * @param priority priority to run timer at (0 min, 255 max)
+ * 
+ * @note follows the same rules as setHardTimer
+ * @note read expiries with readHardTimer from an event loop
+ * 
+ * @return if timer was successfully set
+ */
+bool setHardTimerPolled(hard_timer_enum_t *timer, hard_timer_freq_t *freq,
+		hard_timer_priority_t priority);
+
+/**
+ * Reads expiries of timer since it was last read
+ * 
+ * Expiries that happened between reads are batched into one count,
+ * including periods missed by late expiries
+ * 
+ * @param timer timer to read, polled or with a callback
+ * 
+ * @return expiries since last read or since timer was set
+ */
+uint32_t readHardTimer(hard_timer_enum_t timer);
+
+/**
+ * Gets started timers with expiries not yet read
+ * 
+ * @return bit mask with bit n set when HARD_TIMERn is ready
+ */
+uint32_t getHardTimerReady(void);
+
+/**
+ * Sets function called from ISR whenever a timer overruns
+ * 
+ * @param hook function taking timer and whole periods missed, NULL to disable
+ */
+void setHardTimerOverrunHook(hard_timer_overrun_ptr_t hook);
+
+/**
+ * Gets histogram of delays between expiry deadlines and callback entry
+ * 
+ * Latencies are in cycles of the latency clock: timer ticks on AVR,
+ * microseconds on Pico and CPU cycles on ESP32. ESP32 latencies are
+ * measured from the earliest callback entry seen
+ * 
+ * @param timer timer to get
+ * @param latency pointer to store histogram in
+ * 
+ * @note requires HARD_TIMER_LATENCY_STATS to be defined
+ * @note histogram resets when timer is set
+ * 
+ * @return if histogram was retrieved
+ */
+bool getHardTimerLatency(hard_timer_enum_t timer, hard_timer_latency_t *latency);
+
+/**
+ * Gets execution time profile of timer callback
+ * 
+ * Durations are in cycles of the profile clock: timer ticks on AVR,
+ * microseconds on Pico and CPU cycles on ESP32
+ * 
+ * @param timer timer to get
+ * @param profile pointer to store profile in
+ * 
+ * @note requires HARD_TIMER_PROFILE to be defined
+ * @note profile resets when timer is set
+ * 
+ * @return if profile was retrieved
+ */
+bool getHardTimerProfile(hard_timer_enum_t timer, hard_timer_profile_t *profile);
+
+/**
+ * Gets CPU load of timer callback at its current frequency
+ * 
+ * @param timer timer to get
+ * 
+ * @note requires HARD_TIMER_PROFILE to be defined
+ * 
+ * @return percentage of CPU time spent in callback, 0 to 100
+ */
+uint8_t getHardTimerLoad(hard_timer_enum_t timer);
+
+#if HARDWARE_TIMER_SUPPORT_AVR
+
+/**
+ * Sets timer to toggle its output compare A pin in hardware with no interrupt
+ * 
+ * Pins are OC0A (Arduino pin 6), OC1A (pin 9) and OC2A (pin 11) for hardware
+ * timers 0, 1 and 2. With the Arduino timer skipped, HARD_TIMER0 uses OC1A
+ * and HARD_TIMER1 uses OC2A
+ * 
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired pin frequency in Hz, up to F_CPU / 2
+ * 
+ * @note freq value is changed to achieved pin frequency
+ * @note cancel with cancelHardTimer, which leaves pin at its last level
+ * 
+ * @return if timer was set
+ */
+bool setHardTimerToggle(hard_timer_enum_t *timer, hard_timer_freq_t *freq);
+
+#ifdef HARD_TIMER_AVR_COMPARE_B
+
+/**
+ * Gets compare B timer sharing hardware timer of compare A timer
+ * 
+ * Compare B timers follow every hardware timer, so HARD_TIMER0 pairs with
+ * HARD_TIMER_COMPARE_B(HARD_TIMER0). They only run while their compare A
+ * timer has the hardware timer counting, at its frequency divided by a
+ * whole number. setHardTimer picks them once compare A timers are taken
+ * 
+ * @param timer compare A timer
+ */
+#define HARD_TIMER_COMPARE_B(timer) ((hard_timer_enum_t)((timer) + HARD_TIMER_HARDWARE_COUNT))
+
+/**
+ * Sets phase of compare B timer within period of its compare A timer
+ * 
+ * @param timer compare B timer
+ * @param phase ticks after compare A expiry to expire at,
+ * clamped to compare A period
+ * 
+ * @note takes effect next time timer is set
+ * 
+ * @return if timer is a compare B timer
+ */
+bool setHardTimerPhase(hard_timer_enum_t timer, hard_timer_tick_t phase);
+
+#endif
+
+#ifdef HARD_TIMER_AVR_LEAN
+
+#ifdef OVERRIDE_ARDUINO_TIMER
+	#define HARD_TIMER_AVR_VECTOR_0 TIMER0_COMPA_vect // compare A vector of HARD_TIMER0
+	#define HARD_TIMER_AVR_VECTOR_1 TIMER1_COMPA_vect // compare A vector of HARD_TIMER1
+	#define HARD_TIMER_AVR_VECTOR_2 TIMER2_COMPA_vect // compare A vector of HARD_TIMER2
+#else
+	#define HARD_TIMER_AVR_VECTOR_0 TIMER1_COMPA_vect // compare A vector of HARD_TIMER0
+	#define HARD_TIMER_AVR_VECTOR_1 TIMER2_COMPA_vect // compare A vector of HARD_TIMER1
+#endif
+
+/**
+ * Defines ISR of lean timer with callback inlined into it
+ * 
+ * The ISR only saves registers the callback uses, instead of every
+ * call clobbered register an indirect call needs. Start the timer with
+ * setHardTimer, whose callback is then never called
+ * 
+ * @param num timer number as a literal, 0 for HARD_TIMER0, whose bit
+ * is set in HARD_TIMER_AVR_LEAN
+ * @param function static inline callback with no parameters
+ * 
+ * @note overruns, polled reads, profiling and tracing skip lean timers
+ */
+#define HARD_TIMER_AVR_LEAN_CALLBACK(num, function) \
+	ISR(HARD_TIMER_AVR_VECTOR_ ## num) { \
+		function(); \
+	}
+
+/**
+ * Defines naked ISR of lean timer that toggles pin, saving no registers
+ * 
+ * @param num timer number as a literal, whose bit is set in HARD_TIMER_AVR_LEAN
+ * @param pin input register of pin in low I/O space, such as PINB
+ * @param bit bit of pin in register
+ */
+#define HARD_TIMER_AVR_NAKED_TOGGLE(num, pin, bit) \
+	ISR(HARD_TIMER_AVR_VECTOR_ ## num, ISR_NAKED) { \
+		__asm__ __volatile__ ( \
+			"sbi %0, %1\n\t" \
+			"reti\n\t" \
+			:: "I" (_SFR_IO_ADDR(pin)), "I" (bit) \
+		); \
+	}
+
+/**
+ * Defines naked ISR of lean timer that increments counter, saving only
+ * one register and SREG
+ * 
+ * @param num timer number as a literal, whose bit is set in HARD_TIMER_AVR_LEAN
+ * @param counter volatile uint16_t variable to increment
+ * 
+ * @note read counter with interrupts disabled, since it takes two reads
+ */
+#define HARD_TIMER_AVR_NAKED_COUNT(num, counter) \
+	ISR(HARD_TIMER_AVR_VECTOR_ ## num, ISR_NAKED) { \
+		__asm__ __volatile__ ( \
+			"push r24\n\t" \
+			"in r24, __SREG__\n\t" \
+			"push r24\n\t" \
+			"lds r24, %0\n\t" \
+			"subi r24, 0xFF\n\t" \
+			"sts %0, r24\n\t" \
+			"lds r24, %0+1\n\t" \
+			"sbci r24, 0xFF\n\t" \
+			"sts %0+1, r24\n\t" \
+			"pop r24\n\t" \
+			"out __SREG__, r24\n\t" \
+			"pop r24\n\t" \
+			"reti\n\t" \
+			:: "i" (&(counter)) \
+		); \
+	}
+
+#endif
+
+#endif
+
+/**
+ * Feeds reference timestamp to lock timer to reference clock
+ * 
+ * Call when the reference event happens, such as from a PPS edge interrupt.
+ * The frequency error of the timer clock is estimated between references
+ * and periods are trimmed by fractional ticks so expiries stay phase locked
+ * 
+ * @param timer timer to discipline
+ * @param referenceUs reference time in microseconds
+ * 
+ * @note requires HARD_TIMER_DISCIPLINE to be defined
+ * @note discipline resets when timer is set
+ * 
+ * @return if reference was used
+ */
+bool disciplineHardTimer(hard_timer_enum_t timer, uint64_t referenceUs);
+
+/**
+ * Gets reference clock discipline state of timer
+ * 
+ * @param timer timer to get
+ * @param discipline pointer to store state in
+ * 
+ * @note requires HARD_TIMER_DISCIPLINE to be defined
+ * @note offsetPpb / 1000 is the offset in ppm
+ * 
+ * @return if state was retrieved
+ */
+bool getHardTimerDiscipline(hard_timer_enum_t timer, hard_timer_discipline_t *discipline);
+
+/**
+ * Sets how far timer may expire from its schedule to share a wakeup with another timer
+ * 
+ * Whenever an expiry of another started timer falls within tolerance
+ * of this timer's scheduled expiry, this timer's next expiry moves onto
+ * it so both interrupts come with one wakeup. Expiries go back to their
+ * schedule when nothing is close enough to share with
+ * 
+ * @param timer timer to set, keeps tolerance when it is set again
+ * @param toleranceUs microseconds expiries may move, 0 to disable
+ * 
+ * @note requires HARD_TIMER_SLACK to be defined
+ * @note tolerance is limited to half a period
+ * @note late moves are limited to periods that fit the hardware counter
+ * 
+ * @return if tolerance was set
+ */
+bool setHardTimerTolerance(hard_timer_enum_t timer, uint32_t toleranceUs);
+
+/**
+ * Gets expiry coalescing state of timer
+ * 
+ * @param timer timer to get
+ * @param slack pointer to store state in
+ * 
+ * @note requires HARD_TIMER_SLACK to be defined
+ * @note counts reset when timer is set
+ * 
+ * @return if state was retrieved
+ */
+bool getHardTimerSlack(hard_timer_enum_t timer, hard_timer_slack_t *slack);
+
+/**
+ * Copies trace records from oldest to newest
+ * 
+ * Timestamps are in cycles of the trace clock: microseconds on ESP32
+ * and Pico, and Arduino timer 0 ticks on AVR. AVR timestamps are 0
+ * when OVERRIDE_ARDUINO_TIMER is defined
+ * 
+ * @param records array to store records in
+ * @param maxRecords size of records array
+ * @param clockFreq pointer to store trace clock cycles per second in, or NULL
+ * 
+ * @note requires HARD_TIMER_TRACE to be defined
+ * @note when more records are stored than fit, the newest are copied
+ * 
+ * @return records copied
+ */
+uint16_t getHardTimerTrace(hard_timer_trace_record_t *records, uint16_t maxRecords, hard_timer_freq_t *clockFreq);
+
+/**
+ * Removes all trace records
+ * 
+ * @note requires HARD_TIMER_TRACE to be defined
+ */
+void clearHardTimerTrace();
+
+/**
+ * Runs timer callbacks in the order of fire records
+ * 
+ * Records copied by getHardTimerTrace, or decoded from a dump with
+ * tools/hard_timer_trace.py --replay, call the functions currently set
+ * for their timers in the same order and with the same spacing, divided
+ * by speedup. Event callbacks get the recorded sequence and missed periods,
+ * with timestamps converted from the trace clock to ticks of their timer
+ * and deadlines on a schedule starting at the earliest fire
+ * 
+ * @param records records from oldest to newest
+ * @param count records in array
+ * @param clockFreq trace clock cycles per second of records
+ * @param speedup times faster than recorded to replay, 0 for as fast as possible
+ * 
+ * @note doesn't require HARD_TIMER_TRACE to be defined
+ * @note callbacks run from the caller with interrupts enabled, so cancel
+ * @note timers being replayed first
+ * @note runs as fast as possible when HARD_TIMER_NOW_FREQ is 0
+ * 
+ * @return callbacks run
+ */
+uint16_t replayHardTimerTrace(const hard_timer_trace_record_t *records, uint16_t count, hard_timer_freq_t clockFreq, uint16_t speedup);
+
+/**
+ * Ticks per second of hardTimerNow
+ * 
+ * Microseconds on ESP32 and Pico, and Arduino timer 0 ticks on AVR.
+ * 0 on AVR when OVERRIDE_ARDUINO_TIMER is defined or Arduino isn't used,
+ * since no counter is left free running there
+ */
+#if HARDWARE_TIMER_SUPPORT_ESP32 || HARDWARE_TIMER_SUPPORT_PICO
+	#define HARD_TIMER_NOW_FREQ 1000000UL // native 64 bit microsecond timer
+#elif HARDWARE_TIMER_SUPPORT_AVR && defined(ARDUINO) && !defined(OVERRIDE_ARDUINO_TIMER)
+	#define HARD_TIMER_NOW_FREQ (F_CPU / 64) // Arduino timer 0 extended by its overflow count
+#else
+	#define HARD_TIMER_NOW_FREQ 0UL // no free running counter
+#endif
+
+/**
+ * Gets monotonic timestamp, safe to call from ISRs
+ * 
+ * @note AVR timestamps stay monotonic when read at least every 24 days
+ * @note AVR without Arduino, or with OVERRIDE_ARDUINO_TIMER, has no free
+ * running counter, so this always returns 0 and replays run back to back
+ * 
+ * @return ticks of HARD_TIMER_NOW_FREQ since startup, 0 without a counter
+ */
+uint64_t hardTimerNow();
+
+/**
+ * Converts hardTimerNow ticks to nanoseconds
+ * 
+ * @param ticks ticks of HARD_TIMER_NOW_FREQ
+ * 
+ * @return nanoseconds, 0 without a counter
+ */
+uint64_t hardTimerToNs(uint64_t ticks);
+
+/**
+ * Busy waits for CPU cycles without using a timer
+ * 
+ * Waits on the CPU cycle counter on ESP32 and runs a cycle counted
+ * loop on Pico. AVR waits of 8 Arduino timer 0 ticks or more run on
+ * that timer to within one tick, and shorter ones on a cycle counted
+ * loop. Cost of the call is taken off the wait
+ * 
+ * @param ticks CPU cycles to wait for
+ * 
+ * @note interrupts while waiting lengthen cycle counted waits
+ */
+void hardTimerDelayTicks(uint32_t ticks);
+
+/**
+ * Busy waits for microseconds without using a timer
+ * 
+ * @param us microseconds to wait for
+ * 
+ * @note interrupts while waiting lengthen waits on AVR without Arduino
+ * timer 0, and AVR waits under 8 of its ticks
+ */
+void hardTimerDelayUs(uint32_t us);
+
 /**
  * Gets callback function used for setting timer
  * 
@@ -30,6 +30,23 @@ extern "C" {
  */
 void testTimers();
 
+/**
+ * Measures cost of one expiry and of API calls on all timers
+ * 
+ * @note prints CSV with Serial on Arduino and printf otherwise
+ * @note requires a free running clock, on AVR Arduino timer 0
+ * @note cancels and unclaims all timers
+ */
+void benchmarkTimers();
+
+/**
+ * Prints trace records as hex for tools/hard_timer_trace.py
+ * 
+ * @note requires HARD_TIMER_TRACE to be defined
+ * @note prints with Serial on Arduino and printf otherwise
+ */
+void dumpHardTimerTrace();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""
+	hard_timer_trace.py - decodes trace dumps of hardware timers
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+Reads the output of dumpHardTimerTrace() from a file or stdin, prints a
+timeline and optionally writes Chrome trace JSON for chrome://tracing, or a
+C header of records to pass to replayHardTimerTrace()
+
+	python3 tools/hard_timer_trace.py serial.log --chrome trace.json
+	python3 tools/hard_timer_trace.py serial.log --replay trace_replay.h
+"""
+
+import argparse
+import json
+import re
+import sys
+
+TRACE_START = "hard_timer_trace"
+TRACE_END = "hard_timer_trace_end"
+RECORD_LEN = 16 # hex characters in record
+
+# names of hard_timer_trace_event_t values
+ENUMS = {
+	"none": "HARD_TIMER_TRACE_NONE",
+	"set": "HARD_TIMER_TRACE_SET",
+	"cancel": "HARD_TIMER_TRACE_CANCEL",
+	"fire": "HARD_TIMER_TRACE_FIRE",
+	"overrun": "HARD_TIMER_TRACE_OVERRUN",
+}
+
+# hard_timer_trace_event_t
+EVENTS = {
+	0: "none",
+	1: "set",
+	2: "cancel",
+	3: "fire",
+	4: "overrun",
+}
+
+def parseDump(lines):
+	"""
+	Finds last trace dump in lines
+
+	@param lines lines of serial output
+
+	@return clock frequency and list of records
+	"""
+	clockFreq = 0
+	records = None
+	dump = None
+
+	for line in lines:
+		line = line.strip()
+		if line.startswith(TRACE_START + " "):
+			fields = line.split()
+			clockFreq = int(fields[1])
+			dump = []
+		elif line == TRACE_END:
+			if dump is not None:
+				records = dump
+			dump = None
+		elif dump is not None and len(line) == RECORD_LEN:
+			timer = int(line[8:10], 16)
+			dump.append({
+				"timestamp": int(line[0:8], 16),
+				"timer": timer - 256 if timer >= 128 else timer,
+				"event": EVENTS.get(int(line[10:12], 16), "unknown"),
+				"data": int(line[12:16], 16),
+			})
+
+	if records is None:
+		raise ValueError("no complete trace dump found")
+	return clockFreq, records
+
+def unwrapTimestamps(records):
+	"""
+	Extends 32 bit timestamps past their wraparound
+
+	@param records records from oldest to newest
+	"""
+	offset = 0
+	last = None
+	for record in records:
+		if last is not None and record["timestamp"] < last:
+			offset += 1 << 32
+		last = record["timestamp"]
+		record["time"] = record["timestamp"] + offset
+
+def toMicroseconds(records, clockFreq):
+	"""
+	Converts timestamps to microseconds since first record
+
+	@param records records from oldest to newest
+	@param clockFreq trace clock cycles per second, or 0 for record order
+	"""
+	start = records[0]["time"] if records else 0
+	for index, record in enumerate(records):
+		if clockFreq == 0:
+			record["us"] = float(index)
+		else:
+			record["us"] = (record["time"] - start) * 1000000.0 / clockFreq
+
+def printTimeline(records, out):
+	"""
+	Prints one line per record
+
+	@param records decoded records
+	@param out file to write to
+	"""
+	for record in records:
+		detail = ""
+		if record["event"] == "fire":
+			detail = " sequence %d" % record["data"]
+		elif record["event"] == "overrun":
+			detail = " missed %d" % record["data"]
+		out.write("%14.3f us  timer %d  %s%s\n" % (record["us"], record["timer"], record["event"], detail))
+
+def chromeTrace(records):
+	"""
+	Converts records into Chrome trace events
+
+	@param records decoded records
+
+	@return Chrome trace JSON object
+	"""
+	events = []
+	for record in records:
+		events.append({
+			"name": record["event"],
+			"ph": "i",
+			"s": "t",
+			"ts": record["us"],
+			"pid": 0,
+			"tid": record["timer"],
+			"args": {"data": record["data"]},
+		})
+	return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+def replayHeader(records, clockFreq, name):
+	"""
+	Converts records into C header for replayHardTimerTrace()
+
+	@param records decoded records
+	@param clockFreq trace clock cycles per second
+	@param name name of record array
+
+	@return header source
+	"""
+	prefix = re.sub(r"([a-z0-9])([A-Z])", r"\1_\2", name).upper()
+	guard = prefix + "_H"
+	lines = [
+		"// generated by tools/hard_timer_trace.py --replay",
+		"#ifndef " + guard,
+		"#define " + guard,
+		"",
+		"#include <universal_hardware_timer.h>",
+		"",
+		"#define %s_CLOCK_FREQ %dUL // trace clock cycles per second" % (prefix, clockFreq),
+		"#define %s_COUNT %d // records in %s" % (prefix, len(records), name),
+		"",
+		"static const hard_timer_trace_record_t %s[] = {" % name,
+	]
+	for record in records:
+		lines.append("\t{%dUL, %d, %s, %d}," % (record["timestamp"], record["timer"],
+			ENUMS.get(record["event"], "HARD_TIMER_TRACE_NONE"), record["data"]))
+	lines += ["};", "", "#endif", ""]
+	return "\n".join(lines)
+
+def main():
+	parser = argparse.ArgumentParser(description="Decodes dumpHardTimerTrace() output")
+	parser.add_argument("dump", nargs="?", help="file containing dump, defaults to stdin")
+	parser.add_argument("--chrome", metavar="FILE", help="writes Chrome trace JSON to FILE")
+	parser.add_argument("--replay", metavar="FILE", help="writes C header of records to FILE")
+	parser.add_argument("--name", default="traceReplay", help="name of record array in replay header")
+	parser.add_argument("--quiet", action="store_true", help="doesn't print timeline")
+	args = parser.parse_args()
+
+	if args.dump:
+		with open(args.dump, "r", errors="replace") as dumpFile:
+			lines = dumpFile.readlines()
+	else:
+		lines = sys.stdin.readlines()
+
+	try:
+		clockFreq, records = parseDump(lines)
+	except ValueError as error:
+		sys.stderr.write("%s\n" % error)
+		return 1
+
+	unwrapTimestamps(records)
+	toMicroseconds(records, clockFreq)
+
+	if not args.quiet:
+		printTimeline(records, sys.stdout)
+	if args.chrome:
+		with open(args.chrome, "w") as chromeFile:
+			json.dump(chromeTrace(records), chromeFile, indent=1)
+	if args.replay:
+		with open(args.replay, "w") as replayFile:
+			replayFile.write(replayHeader(records, clockFreq, args.name))
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())